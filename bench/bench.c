@@ -0,0 +1,517 @@
+/*****************************************************************************
+
+bench.c
+
+Measures the throughput and latency of path translation through cygpath(),
+and checks its output against a corpus recorded from `cygpath` on a Cygwin
+host (see record.sh).
+
+    bench [-n <count>] <path list>      times <count> translations per mode
+    bench -c <corpus>                   compares translations to the corpus
+
+Path lists have one Windows path per line.  Corpus lines hold a path and its
+four translations (-u, -w, -m, -d), separated by tabs.  An empty translation
+means `cygpath` rejected the path.  Blank lines and lines starting with `#`
+are skipped in both.  The corpus is checked one line at a time, so it may be
+any size.  A line longer than LINE_SIZE is an error, not a short read.
+
+*****************************************************************************/
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <windows.h>
+#include <tchar.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "path.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+#define BENCH_COUNT ( 200 )         //default translations timed per mode
+
+#define BENCH_CODEPAGE ( CP_ACP )   //code page of lists (same as path.c)
+
+#define FIELD_COUNT ( 5 )           //fields in a corpus line
+
+#define LINE_SIZE ( 2048 )          //size of a line of a list (with its
+                                    //  line ending and terminator)
+
+#define PATHS_GROWTH ( 256 )        //paths added to the table at a time
+
+#define MODE_COUNT ( 4 )            //number of translation modes
+
+#define PATH_SIZE ( 512 )           //size of path buffers (same as main.c)
+
+#define READ_END ( -1 )             //read_line(): no more lines
+
+#define READ_ERROR ( -2 )           //read_line(): the file can't be read
+
+#define READ_LONG ( -3 )            //read_line(): a line does not fit
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+static const char*      mode_names[ MODE_COUNT ] = {
+    "unix (-u)",                    //PATH_OPT_UNIX
+    "win (-w)",                     //PATH_OPT_WIN
+    "mixed (-m)",                   //PATH_OPT_MIXED
+    "dos (-d)"                      //PATH_OPT_DOS
+};                                  //names of the translation modes
+
+/*----------------------------------------------------------------------------
+Module Variables
+----------------------------------------------------------------------------*/
+
+static char             line[ LINE_SIZE ];
+                                    //current line of a path list or corpus
+static int              path_count = 0;
+                                    //number of paths in the table
+static char**           paths = NULL;
+                                    //paths read from a path list
+
+/*----------------------------------------------------------------------------
+Module Prototypes
+----------------------------------------------------------------------------*/
+
+static int compare_times(           //orders latencies for qsort
+    const void*         left,       //first latency
+    const void*         right       //second latency
+);                                  //<0, 0, or >0
+
+static int load_paths(              //reads a path list into the table
+    const char*         name        //name of the file
+);                                  //number of paths read (-1 on error)
+
+static int read_line(               //reads the next path or corpus line
+    FILE*               file,       //file being read
+    int*                number      //line number of the last line read
+);                                  //length of the line (or READ_*)
+
+static int run_bench(               //times translations in each mode
+    int                 count       //translations per mode
+);                                  //exit code (0 = no failed translations)
+
+static int run_check(               //compares translations to a corpus
+    const char*         name        //name of the corpus file
+);                                  //exit code (0 = all translations match)
+
+static error_t translate(           //translates a path with cygpath()
+    char*               output,     //translated path output (bytes)
+    size_t              size,       //size of output
+    const char*         input,      //path to translate (bytes)
+    path_options_t      mode        //translation mode
+);                                  //length of output or error
+
+
+/*==========================================================================*/
+int main(                           //benchmark entry point
+    int                 argc,       //number of arguments
+    char**              argv        //argument strings
+) {                                 //exit code
+
+    //local variables
+    int                 count;      //translations per mode
+    int                 loaded;     //number of paths loaded
+
+    //compare translations to a recorded corpus
+    if( ( argc == 3 ) && ( strcmp( argv[ 1 ], "-c" ) == 0 ) ) {
+        return run_check( argv[ 2 ] );
+    }
+
+    //time translations of a path list
+    count = BENCH_COUNT;
+    if( ( argc == 4 ) && ( strcmp( argv[ 1 ], "-n" ) == 0 ) ) {
+        count = atoi( argv[ 2 ] );
+        argv += 2;
+        argc -= 2;
+    }
+    if( ( argc != 2 ) || ( count < 1 ) ) {
+        fprintf(
+            stderr,
+            "usage: bench [-n <count>] <path list>\n"
+            "       bench -c <corpus>\n"
+        );
+        return 2;
+    }
+
+    loaded = load_paths( argv[ 1 ] );
+    if( loaded == 0 ) {
+        fprintf( stderr, "bench: no paths in %s\n", argv[ 1 ] );
+    }
+    if( loaded <= 0 ) {
+        return 2;
+    }
+    return run_bench( count );
+}
+
+
+/*=========================================================================*/
+static int compare_times(           //orders latencies for qsort
+    const void*         left,       //first latency
+    const void*         right       //second latency
+) {                                 //<0, 0, or >0
+
+    //local variables
+    double              a;          //first latency
+    double              b;          //second latency
+
+    a = *( const double* ) left;
+    b = *( const double* ) right;
+    return ( a > b ) - ( a < b );
+}
+
+
+/*=========================================================================*/
+static int load_paths(              //reads a path list into the table
+    const char*         name        //name of the file
+) {                                 //number of paths read (-1 on error)
+
+    //local variables
+    int                 capacity;   //number of paths the table can hold
+    FILE*               file;       //the path list
+    char**              grown;      //table after growing
+    int                 length;     //length of a line (or READ_*)
+    int                 number;     //line number of the last line read
+
+    file = fopen( name, "rb" );
+    if( file == NULL ) {
+        fprintf( stderr, "bench: can not open %s\n", name );
+        return -1;
+    }
+
+    //keep every path (the table grows as needed)
+    capacity = 0;
+    number   = 0;
+    while( ( length = read_line( file, &number ) ) > 0 ) {
+        if( path_count == capacity ) {
+            capacity += PATHS_GROWTH;
+            grown = realloc( paths, ( capacity * sizeof( char* ) ) );
+            if( grown == NULL ) {
+                length = READ_ERROR;
+                break;
+            }
+            paths = grown;
+        }
+        paths[ path_count ] = malloc( length + 1 );
+        if( paths[ path_count ] == NULL ) {
+            length = READ_ERROR;
+            break;
+        }
+        memcpy( paths[ path_count ], line, ( length + 1 ) );
+        ++path_count;
+    }
+    fclose( file );
+
+    //a list that is not read in full is not timed
+    if( length == READ_LONG ) {
+        fprintf(
+            stderr,
+            "bench: %s:%d: line (and its ending) is over %d bytes\n",
+            name,
+            number,
+            ( LINE_SIZE - 1 )
+        );
+        return -1;
+    }
+    if( length == READ_ERROR ) {
+        fprintf( stderr, "bench: can not read %s\n", name );
+        return -1;
+    }
+
+    //return the number of paths
+    return path_count;
+}
+
+
+/*=========================================================================*/
+static int read_line(               //reads the next path or corpus line
+    FILE*               file,       //file being read
+    int*                number      //line number of the last line read
+) {                                 //length of the line (or READ_*)
+
+    //local variables
+    size_t              length;     //length of the line
+
+    //skip blank lines and comments
+    for( ; ; ) {
+        if( fgets( line, LINE_SIZE, file ) == NULL ) {
+            return ( ferror( file ) != 0 ) ? READ_ERROR : READ_END;
+        }
+        *number += 1;
+
+        //a line without a line ending is only whole at the end of the file
+        length = strlen( line );
+        if(
+            ( ( length == 0 ) || ( line[ length - 1 ] != '\n' ) )
+            &&
+            ( feof( file ) == 0 )
+        ) {
+            return READ_LONG;
+        }
+
+        //keep the line without its line ending
+        while(
+            ( length > 0 )
+            &&
+            (
+                ( line[ length - 1 ] == '\n' )
+                ||
+                ( line[ length - 1 ] == '\r' )
+            )
+        ) {
+            line[ --length ] = 0;
+        }
+        if( ( length > 0 ) && ( line[ 0 ] != '#' ) ) {
+            return ( int ) length;
+        }
+    }
+}
+
+
+/*=========================================================================*/
+static int run_bench(               //times translations in each mode
+    int                 count       //translations per mode
+) {                                 //exit code (0 = no failed translations)
+
+    //local variables
+    LARGE_INTEGER       after;      //counter after a translation
+    LARGE_INTEGER       before;     //counter before a translation
+    int                 failed;     //failed translations in a mode
+    LARGE_INTEGER       frequency;  //counter ticks per second
+    int                 index;      //index of a translation
+    int                 mode;       //translation mode
+    static char         output[ PATH_SIZE ];
+                                    //translated path
+    double*             times;      //latency of each translation (ms)
+    double              total;      //time spent in all translations (ms)
+    int                 total_failed;
+                                    //failed translations in all modes
+
+    times = malloc( count * sizeof( double ) );
+    if( times == NULL ) {
+        return 2;
+    }
+    QueryPerformanceFrequency( &frequency );
+
+    printf(
+        "%d translations per mode over %d path(s)\n",
+        count,
+        path_count
+    );
+    total_failed = 0;
+    for( mode = 0; mode < MODE_COUNT; ++mode ) {
+
+        //the first translation loads cygpath and its DLLs into the cache
+        translate( output, PATH_SIZE, paths[ 0 ], mode );
+
+        //time each translation on its own
+        failed = 0;
+        total  = 0.0;
+        for( index = 0; index < count; ++index ) {
+            QueryPerformanceCounter( &before );
+            if(
+                translate(
+                    output,
+                    PATH_SIZE,
+                    paths[ index % path_count ],
+                    mode
+                )
+                < ERROR_NONE
+            ) {
+                ++failed;
+            }
+            QueryPerformanceCounter( &after );
+            times[ index ] = ( double ) ( after.QuadPart - before.QuadPart )
+                * 1000.0 / ( double ) frequency.QuadPart;
+            total += times[ index ];
+        }
+
+        //report throughput and nearest-rank percentiles
+        qsort( times, count, sizeof( double ), compare_times );
+        printf(
+            "%-10s %9.1f paths/s  p50 %8.3f ms  p99 %8.3f ms  %d failed\n",
+            mode_names[ mode ],
+            ( total > 0.0 ) ? ( count * 1000.0 / total ) : 0.0,
+            times[ ( ( count * 50 ) + 99 ) / 100 - 1 ],
+            times[ ( ( count * 99 ) + 99 ) / 100 - 1 ],
+            failed
+        );
+        total_failed += failed;
+    }
+
+    free( times );
+    return ( total_failed == 0 ) ? 0 : 1;
+}
+
+
+/*=========================================================================*/
+static int run_check(               //compares translations to a corpus
+    const char*         name        //name of the corpus file
+) {                                 //exit code (0 = all translations match)
+
+    //local variables
+    char*               fields[ FIELD_COUNT ];
+                                    //path, then its translation per mode
+    int                 field;      //index of a field
+    int                 checked;    //number of translations checked
+    FILE*               file;       //the corpus
+    int                 length;     //length of a line (or READ_*)
+    int                 mismatched; //number of translations that differ
+    int                 mode;       //translation mode
+    int                 number;     //line number of the last line read
+    static char         output[ PATH_SIZE ];
+                                    //translated path
+    error_t             result;     //result of a translation
+
+    file = fopen( name, "rb" );
+    if( file == NULL ) {
+        fprintf( stderr, "bench: can not open %s\n", name );
+        return 2;
+    }
+
+    //check one line at a time
+    checked    = 0;
+    mismatched = 0;
+    number     = 0;
+    while( ( length = read_line( file, &number ) ) > 0 ) {
+
+        //split the line into its fields
+        fields[ 0 ] = line;
+        for( field = 1; field < FIELD_COUNT; ++field ) {
+            fields[ field ] = strchr( fields[ field - 1 ], '\t' );
+            if( fields[ field ] == NULL ) {
+                break;
+            }
+            *fields[ field ]++ = 0;
+        }
+        if( field < FIELD_COUNT ) {
+            fprintf( stderr, "bench: %s:%d: line is short\n", name, number );
+            checked    += MODE_COUNT;
+            mismatched += MODE_COUNT;
+            continue;
+        }
+
+        //translations must match byte for byte (or fail where cygpath did)
+        for( mode = 0; mode < MODE_COUNT; ++mode ) {
+            ++checked;
+            result = translate( output, PATH_SIZE, fields[ 0 ], mode );
+            if( fields[ 1 + mode ][ 0 ] == 0 ) {
+                if( result < ERROR_NONE ) {
+                    continue;
+                }
+            }
+            else if(
+                ( result >= ERROR_NONE )
+                &&
+                ( strcmp( output, fields[ 1 + mode ] ) == 0 )
+            ) {
+                continue;
+            }
+            ++mismatched;
+            printf(
+                "mismatch: %s %s\n  expected: %s\n  got:      %s (%ld)\n",
+                mode_names[ mode ],
+                fields[ 0 ],
+                ( fields[ 1 + mode ][ 0 ] == 0 )
+                    ? "(error)" : fields[ 1 + mode ],
+                ( result < ERROR_NONE ) ? "(error)" : output,
+                result
+            );
+        }
+    }
+    fclose( file );
+
+    //a corpus that is not read in full does not pass
+    if( length == READ_LONG ) {
+        fprintf(
+            stderr,
+            "bench: %s:%d: line (and its ending) is over %d bytes\n",
+            name,
+            number,
+            ( LINE_SIZE - 1 )
+        );
+        return 2;
+    }
+    if( length == READ_ERROR ) {
+        fprintf( stderr, "bench: can not read %s\n", name );
+        return 2;
+    }
+    if( checked == 0 ) {
+        fprintf( stderr, "bench: no corpus lines in %s\n", name );
+        return 2;
+    }
+
+    printf(
+        "%d of %d translations match\n",
+        ( checked - mismatched ),
+        checked
+    );
+    return ( mismatched == 0 ) ? 0 : 1;
+}
+
+
+/*=========================================================================*/
+static error_t translate(           //translates a path with cygpath()
+    char*               output,     //translated path output (bytes)
+    size_t              size,       //size of output
+    const char*         input,      //path to translate (bytes)
+    path_options_t      mode        //translation mode
+) {                                 //length of output or error
+
+    //local variables
+    #ifdef UNICODE
+    static WCHAR        wide_input[ PATH_SIZE ];
+                                    //path to translate
+    static WCHAR        wide_output[ PATH_SIZE ];
+                                    //translated path
+    error_t             result;     //result of translation
+    #endif
+
+    //multi-byte builds pass the bytes through unchanged
+    #ifndef UNICODE
+
+        return cygpath( output, size, input, mode );
+
+    //wide builds convert with the code page path.c uses for cygpath output,
+    //  so the bytes compared are the bytes cygpath wrote
+    #else
+
+        if(
+            MultiByteToWideChar(
+                BENCH_CODEPAGE, 0, input, -1, wide_input, PATH_SIZE
+            ) <= 0
+        ) {
+            return ERROR_API_RESULT;
+        }
+
+        result = cygpath( wide_output, PATH_SIZE, wide_input, mode );
+
+        if( result < ERROR_NONE ) {
+            return result;
+        }
+
+        if(
+            WideCharToMultiByte(
+                BENCH_CODEPAGE, 0, wide_output, -1, output, ( int ) size,
+                NULL, NULL
+            ) <= 0
+        ) {
+            return ERROR_OUTPUT_SIZE;
+        }
+
+        return strlen( output );
+
+    #endif
+}
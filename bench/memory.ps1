@@ -0,0 +1,52 @@
+##############################################################################
+#
+#  memory.ps1
+#
+#  Measures the memory held by this program while consoles are open: one
+#  waiting launcher per console in the default build, or only the status
+#  broker with CONFIG_DETACHED set to 1.  Run it once with each build:
+#
+#      powershell -File bench\memory.ps1 -Image build\vimassoc.exe -Count 10
+#
+#  It opens -Count consoles on -File, waits -Settle seconds, and reports the
+#  number of this program's processes left running, with their total working
+#  set and private bytes.  The consoles (and launchers) it started are then
+#  closed.
+#
+##############################################################################
+
+param(
+    [Parameter( Mandatory = $true )]
+    [string] $Image,                    # launcher to measure
+    [int]    $Count   = 10,             # number of consoles to open
+    [string] $File    = $PSCommandPath, # file opened in each console
+    [string] $Console = 'mintty',       # process name of the console
+    [int]    $Settle  = 5               # seconds to wait before measuring
+)
+
+$name    = [IO.Path]::GetFileNameWithoutExtension( $Image )
+$started = @( Get-Process -ErrorAction SilentlyContinue |
+    ForEach-Object { $_.Id } )
+
+# open the consoles
+for( $index = 0; $index -lt $Count; ++$index ) {
+    Start-Process -FilePath $Image -ArgumentList "`"$File`""
+}
+Start-Sleep -Seconds $Settle
+
+# measure every process of this program (launchers and the broker)
+$held    = @( Get-Process -Name $name -ErrorAction SilentlyContinue )
+$working = ( $held | Measure-Object -Property WorkingSet64 -Sum ).Sum
+$private = ( $held | Measure-Object -Property PrivateMemorySize64 -Sum ).Sum
+
+'{0} console(s) open, {1} {2} process(es) running' -f
+    $Count, $held.Count, $name
+'  working set:   {0,10:N0} KiB total, {1,8:N0} KiB per console' -f
+    ( $working / 1KB ), ( $working / 1KB / $Count )
+'  private bytes: {0,10:N0} KiB total, {1,8:N0} KiB per console' -f
+    ( $private / 1KB ), ( $private / 1KB / $Count )
+
+# close what the measurement started
+Get-Process -Name $Console, $name -ErrorAction SilentlyContinue |
+    Where-Object { $started -notcontains $_.Id } |
+    Stop-Process -Force
@@ -0,0 +1,136 @@
+#!/bin/sh
+##############################################################################
+#
+#  paths.sh
+#
+#  Generates a list of Windows paths for `bench` and record.sh, in the forms
+#  the launcher is given in practice.  Runs anywhere with a POSIX shell and
+#  awk:
+#
+#      bench/paths.sh 20000 > bench/paths-20000.txt
+#
+#  The list cycles through drive paths, UNC paths, `\\?\` paths (for drives
+#  and UNC), mixed forward and back slashes, DOS short names, names with
+#  spaces, names with non-ASCII letters, relative paths, and paths near
+#  MAX_PATH.  Apart from a few paths that exist on most hosts, names are
+#  numbered so that no two paths are the same.  The same count always gives
+#  the same list.
+#
+#  Non-ASCII letters are written in Windows-1252, the ANSI code page `bench`
+#  reads lists in on most western systems.  Record a corpus from the list
+#  with `cygpath` using the same character set:
+#
+#      LC_ALL=en_US.CP1252 bench/record.sh bench/paths-20000.txt \
+#          > bench/corpus.tsv
+#
+##############################################################################
+
+if [ $# -gt 1 ]; then
+    echo "usage: $0 [count]" >&2
+    exit 2
+fi
+count="${1:-20000}"
+case "$count" in
+    ''|*[!0-9]*)
+        echo "usage: $0 [count]" >&2
+        exit 2
+        ;;
+esac
+
+echo "# generated by paths.sh $count"
+
+awk -v count="$count" '
+BEGIN {
+    # a few directories that exist on most hosts (so -d can shorten them)
+    real[ 0 ] = "C:\\Windows\\System32\\drivers\\etc\\hosts"
+    real[ 1 ] = "C:\\Windows\\win.ini"
+    real[ 2 ] = "C:\\Program Files\\Common Files"
+    real[ 3 ] = "C:\\Program Files (x86)\\Common Files"
+    real[ 4 ] = "C:\\Users\\Public\\Documents"
+    real[ 5 ] = "C:\\cygwin\\bin\\cygpath.exe"
+    real[ 6 ] = "C:\\cygwin64\\home"
+    real[ 7 ] = "C:\\ProgramData"
+
+    # short names as dir /x shows them
+    short[ 0 ] = "C:\\PROGRA~1\\COMMON~1"
+    short[ 1 ] = "C:\\PROGRA~2\\MICROS~1"
+    short[ 2 ] = "C:\\DOCUME~1\\ADMINI~1\\LOCALS~1\\Temp"
+    short[ 3 ] = "C:\\Users\\ADMINI~1\\AppData\\Local\\Temp"
+    short[ 4 ] = "D:\\MYDOCU~1\\PROJEC~1"
+
+    # non-ASCII names (Windows-1252)
+    accent[ 0 ] = "Jos\351"
+    accent[ 1 ] = "r\351sum\351"
+    accent[ 2 ] = "M\374ller"
+    accent[ 3 ] = "\334bersicht"
+    accent[ 4 ] = "Bj\366rk"
+    accent[ 5 ] = "na\357ve"
+    accent[ 6 ] = "Stra\337e"
+    accent[ 7 ] = "fa\347ade"
+
+    ext[ 0 ] = "c"
+    ext[ 1 ] = "h"
+    ext[ 2 ] = "txt"
+    ext[ 3 ] = "py"
+    ext[ 4 ] = "vim"
+    ext[ 5 ] = "md"
+
+    drives = "CDEFXZcd"
+
+    for( i = 0; i < count; ++i ) {
+        n     = int( i / 12 )
+        drive = substr( drives, ( n % 8 ) + 1, 1 )
+        file  = "file" n "." ext[ n % 6 ]
+        user  = "user" ( n % 50 )
+        kind  = i % 12
+
+        if( kind == 0 ) {
+            path = drive ":\\Users\\" user "\\Documents\\project" n \
+                "\\src\\" file
+        }
+        else if( kind == 1 ) {
+            path = real[ n % 8 ]
+        }
+        else if( kind == 2 ) {
+            path = "\\\\server" ( n % 20 ) "\\share" ( n % 7 ) \
+                "\\team\\" user "\\" file
+        }
+        else if( kind == 3 ) {
+            path = "\\\\?\\" drive ":\\Users\\" user "\\work" n "\\" file
+        }
+        else if( kind == 4 ) {
+            path = "\\\\?\\UNC\\server" ( n % 20 ) "\\share" ( n % 7 ) \
+                "\\" file
+        }
+        else if( kind == 5 ) {
+            path = drive ":/Users/" user "\\Documents/project" n "/" file
+        }
+        else if( kind == 6 ) {
+            path = short[ n % 5 ] "\\FILE" n "~1." \
+                toupper( ext[ n % 6 ] )
+        }
+        else if( kind == 7 ) {
+            path = drive ":\\Program Files (x86)\\My App " n \
+                "\\read me " n ".txt"
+        }
+        else if( kind == 8 ) {
+            path = drive ":\\Users\\" accent[ n % 8 ] "\\Documents\\" \
+                accent[ ( n + 3 ) % 8 ] " " n ".txt"
+        }
+        else if( kind == 9 ) {
+            path = "..\\src" n "\\" file
+        }
+        else if( kind == 10 ) {
+            path = drive ":\\tmp\\.\\build" n "\\..\\" file
+        }
+        else {
+            # just under MAX_PATH
+            path = drive ":\\deep" n
+            while( length( path ) < 230 ) {
+                path = path "\\directory" ( length( path ) % 10 )
+            }
+            path = path "\\" file
+        }
+        print path
+    }
+}'
@@ -0,0 +1,41 @@
+#!/bin/sh
+##############################################################################
+#
+#  record.sh
+#
+#  Records the translations `cygpath` makes of a list of Windows paths, as a
+#  corpus for `bench -c`.  Run this on a Cygwin host:
+#
+#      bench/record.sh bench/paths.txt > bench/corpus.tsv
+#
+#  Lists from paths.sh hold non-ASCII names in Windows-1252, so record them
+#  in a locale with that character set (LC_ALL=en_US.CP1252).
+#
+#  Each output line holds the path, then its `-u`, `-w`, `-m`, and `-d`
+#  translations, separated by tabs.  A translation that `cygpath` rejects is
+#  recorded as an empty field.
+#
+##############################################################################
+
+if [ $# -ne 1 ]; then
+    echo "usage: $0 <path list>" >&2
+    exit 2
+fi
+
+echo "# recorded by record.sh with $(cygpath -V 2>/dev/null | head -n 1)"
+
+tr -d '\r' < "$1" | while IFS= read -r path; do
+
+    # blank lines and comments are not paths
+    case "$path" in
+        ''|'#'*) continue ;;
+    esac
+
+    # like the launcher, keep the output without its line ending
+    line="$path"
+    for mode in -u -w -m -d; do
+        translated=$(cygpath "$mode" "$path" 2>/dev/null) || translated=''
+        line="$line	$translated"
+    done
+    printf '%s\n' "$line"
+done
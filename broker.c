@@ -0,0 +1,722 @@
+/*****************************************************************************
+
+broker.c
+
+Console exit status broker.  In detached mode, each launch hands its console
+process over to the broker and exits.  The broker is a single instance of
+this program (run with the "--broker" argument) that holds the handles of
+every detached console, and remembers their exit codes for anyone who asks.
+The broker is started on demand.  It exits once it has been idle for a while
+with no consoles left to watch and no exit codes that have yet to be asked
+for.  An exit code that is never asked for is kept for BROKER_RETENTION after
+its console exits.
+
+*****************************************************************************/
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <windows.h>
+#include <tchar.h>
+#include <strsafe.h>
+
+#include "broker.h"
+#include "error.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+#define NAME_SIZE ( 64 )            //pipe name buffer size
+
+#define IMAGE_SIZE ( 512 )          //program image path buffer size
+
+#define BROKER_TIMEOUT ( 2000 )     //pipe transaction time limit (ms)
+
+#define BROKER_IDLE_TIMEOUT ( 60000 )
+                                    //idle time before broker exits (ms)
+
+#define BROKER_RETENTION ( 24UL * 60UL * 60UL * 1000UL )
+                                    //longest an exit code waits for a
+                                    //  query (ms)
+
+#define BROKER_START_TRIES ( 40 )   //attempts to reach a starting broker
+
+#define BROKER_START_DELAY ( 50 )   //delay between start attempts (ms)
+
+#define BROKER_MAX_TRACKED ( MAXIMUM_WAIT_OBJECTS - 1 )
+                                    //most running consoles (+ pipe event)
+
+#define BROKER_MAX_FINISHED ( 64 )  //most remembered exit codes (the
+                                    //  oldest are replaced, queried first)
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+enum {                              //broker request commands
+    BROKER_REGISTER,                //start tracking a console
+    BROKER_QUERY                    //report a console's status
+};
+
+typedef struct broker_request_s {   //request sent to the broker
+    DWORD               command;    //requested command
+    DWORD               pid;        //process ID of the console
+} broker_request_t;
+
+typedef struct broker_reply_s {     //reply sent by the broker
+    error_t             result;     //error code (0 = no error)
+    DWORD               running;    //non-zero if the console is running
+    DWORD               exit_code;  //exit code (if the console exited)
+} broker_reply_t;
+
+typedef struct broker_record_s {    //exit code of a finished console
+    DWORD               pid;        //process ID of the console (0 = unused)
+    DWORD               exit_code;  //exit code of the console
+    DWORD               finished;   //tick count when the console exited
+    BOOL                queried;    //exit code has been asked for
+} broker_record_t;
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Module Variables
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Module Prototypes
+----------------------------------------------------------------------------*/
+
+static error_t pipe_name(           //builds the broker's pipe name
+    LPTSTR              name        //pipe name output (NAME_SIZE)
+);                                  //error code (0 = no error)
+
+static BOOL pipe_transfer(          //reads or writes one pipe message
+    HANDLE              pipe,       //overlapped pipe handle
+    void*               buffer,     //message buffer
+    DWORD               size,       //size of the message
+    BOOL                write       //TRUE to write, FALSE to read
+);                                  //TRUE if the whole message moved
+
+static int record_slot(             //selects a record to replace
+    const broker_record_t*
+                        records     //finished console records
+);                                  //index of the record
+
+static BOOL records_pending(        //checks for exit codes not asked for
+    const broker_record_t*
+                        records     //finished console records
+);                                  //TRUE if any should still be kept
+
+static error_t start_broker(        //starts a broker process
+    void
+);                                  //error code (0 = no error)
+
+static error_t transact(            //sends a request to the broker
+    broker_request_t*   request,    //request to send
+    broker_reply_t*     reply,      //reply from the broker
+    BOOL*               running     //set if a broker was reached
+);                                  //error code (0 = no error)
+
+
+/*==========================================================================*/
+error_t broker_query(               //asks the broker for a console's status
+    DWORD               pid,        //process ID of the console
+    BOOL*               running,    //set if the console is still running
+    DWORD*              exit_code   //exit code (if the console exited)
+) {                                 //error code (0 = no error)
+
+    //local variables
+    BOOL                reached;    //a broker was reached
+    broker_reply_t      reply;      //reply from the broker
+    broker_request_t    request;    //request to the broker
+    error_t             result;     //result of the transaction
+
+    //check input
+    if( ( running == NULL ) || ( exit_code == NULL ) ) {
+        return ERROR_USAGE;
+    }
+
+    //ask the broker about the console
+    request.command = BROKER_QUERY;
+    request.pid     = pid;
+    result = transact( &request, &reply, &reached );
+
+    //without a broker, nothing is tracked
+    if( reached == FALSE ) {
+        return ERROR_UNTRACKED;
+    }
+
+    if( result != ERROR_NONE ) {
+        return result;
+    }
+
+    //report the console's status (a console may exit with STILL_ACTIVE, so
+    //  only the running flag says whether it is still running)
+    *running   = ( reply.running != 0 ) ? TRUE : FALSE;
+    *exit_code = reply.exit_code;
+    return reply.result;
+}
+
+
+/*==========================================================================*/
+error_t broker_register(            //hands a console over to the broker
+    HANDLE              process     //handle to the console process
+) {                                 //error code (0 = no error)
+
+    //local variables
+    broker_reply_t      reply;      //reply from the broker
+    broker_request_t    request;    //request to the broker
+    error_t             result;     //result of the transaction
+    BOOL                running;    //a broker was reached
+    int                 tries;      //attempts to reach a new broker
+
+    //the caller's handle keeps the process (and its ID) valid until the
+    //  broker has opened its own handle
+    request.command = BROKER_REGISTER;
+    request.pid     = GetProcessId( process );
+
+    if( request.pid == 0 ) {
+        return ERROR_API_RESULT;
+    }
+
+    //try an existing broker first
+    result = transact( &request, &reply, &running );
+
+    //start a broker if there isn't one, and wait for it to listen
+    if( running == FALSE ) {
+        result = start_broker();
+        if( result != ERROR_NONE ) {
+            return result;
+        }
+        for( tries = 0; tries < BROKER_START_TRIES; ++tries ) {
+            Sleep( BROKER_START_DELAY );
+            result = transact( &request, &reply, &running );
+            if( running == TRUE ) {
+                break;
+            }
+        }
+    }
+
+    if( result != ERROR_NONE ) {
+        return result;
+    }
+
+    //return the broker's result
+    return reply.result;
+}
+
+
+/*==========================================================================*/
+int broker_serve(                   //runs the broker until it is idle
+    void
+) {                                 //program exit status
+
+    //local variables
+    int                 count;      //number of tracked consoles
+    BOOL                done;       //broker should exit
+    DWORD               error;      //last error from Win32 calls
+    broker_record_t     finished[ BROKER_MAX_FINISHED ];
+                                    //exit codes of finished consoles
+    HANDLE              handles[ MAXIMUM_WAIT_OBJECTS ];
+                                    //pipe event, then tracked consoles
+    int                 index;      //handle/record index
+    TCHAR               name[ NAME_SIZE ];
+                                    //name of the broker's pipe
+    OVERLAPPED          overlapped; //state of the pipe connection
+    HANDLE              pipe;       //broker's pipe
+    DWORD               pids[ MAXIMUM_WAIT_OBJECTS ];
+                                    //process IDs of tracked consoles
+    broker_record_t*    record;     //record of a finished console
+    broker_reply_t      reply;      //reply to a client
+    broker_request_t    request;    //request from a client
+    DWORD               wait_result;//result of waiting on handles
+    BOOL                win_result; //result of Win32 calls
+
+    //create the broker's pipe (only one broker may own it)
+    if( pipe_name( name ) != ERROR_NONE ) {
+        return 1;
+    }
+
+    pipe = CreateNamedPipe(
+        name,
+        PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED
+            | FILE_FLAG_FIRST_PIPE_INSTANCE,
+        PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT,
+        1,
+        sizeof( broker_reply_t ),
+        sizeof( broker_request_t ),
+        0,
+        NULL
+    );
+
+    if( pipe == INVALID_HANDLE_VALUE ) {
+        return 1;
+    }
+
+    //initialize the connection state and the tracking tables
+    memset( &overlapped, 0, sizeof( overlapped ) );
+    overlapped.hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+
+    if( overlapped.hEvent == NULL ) {
+        CloseHandle( pipe );
+        return 1;
+    }
+
+    memset( finished, 0, sizeof( finished ) );
+    handles[ 0 ] = overlapped.hEvent;
+    count        = 0;
+    done         = FALSE;
+
+    //serve clients and watch consoles
+    while( done == FALSE ) {
+
+        //wait for the next client
+        ResetEvent( overlapped.hEvent );
+        win_result = ConnectNamedPipe( pipe, &overlapped );
+        error      = GetLastError();
+
+        if( win_result == FALSE ) {
+            if( error == ERROR_PIPE_CONNECTED ) {
+                SetEvent( overlapped.hEvent );
+            }
+            else if( error != ERROR_IO_PENDING ) {
+                break;
+            }
+        }
+
+        //watch consoles until a client connects
+        for( ; ; ) {
+
+            wait_result = WaitForMultipleObjects(
+                ( count + 1 ),
+                handles,
+                FALSE,
+                ( count == 0 ) ? BROKER_IDLE_TIMEOUT : INFINITE
+            );
+
+            //a client connected
+            if( wait_result == WAIT_OBJECT_0 ) {
+                break;
+            }
+
+            //a console exited, so remember its exit code
+            index = wait_result - WAIT_OBJECT_0;
+            if( ( index > 0 ) && ( index <= count ) ) {
+                record           = &finished[ record_slot( finished ) ];
+                record->pid      = pids[ index ];
+                record->finished = GetTickCount();
+                record->queried  = FALSE;
+                if(
+                    GetExitCodeProcess(
+                        handles[ index ],
+                        &record->exit_code
+                    ) == FALSE
+                ) {
+                    record->exit_code = 1;
+                }
+                CloseHandle( handles[ index ] );
+                handles[ index ] = handles[ count ];
+                pids[ index ]    = pids[ count ];
+                count -= 1;
+                continue;
+            }
+
+            //idle, but exit codes are still waiting to be asked for
+            if(
+                ( wait_result == WAIT_TIMEOUT )
+                &&
+                ( records_pending( finished ) == TRUE )
+            ) {
+                continue;
+            }
+
+            //idle with nothing to watch or keep, or the wait failed
+            done = TRUE;
+            break;
+        }
+
+        if( done == TRUE ) {
+            CancelIo( pipe );
+            break;
+        }
+
+        //handle the client's request
+        if( pipe_transfer( pipe, &request, sizeof( request ), FALSE ) ) {
+
+            reply.result    = ERROR_UNTRACKED;
+            reply.running   = 0;
+            reply.exit_code = 0;
+
+            //look for the console among the running consoles
+            for( index = 1; index <= count; ++index ) {
+                if( pids[ index ] == request.pid ) {
+                    reply.result    = ERROR_NONE;
+                    reply.running   = 1;
+                    reply.exit_code = STILL_ACTIVE;
+                    break;
+                }
+            }
+
+            //look for the console among the finished consoles (a newly
+            //  registered console may reuse the ID of a finished one)
+            for( index = 0; index < BROKER_MAX_FINISHED; ++index ) {
+                if(
+                    ( reply.result == ERROR_UNTRACKED )
+                    &&
+                    ( request.pid != 0 )
+                    &&
+                    ( finished[ index ].pid == request.pid )
+                ) {
+                    if( request.command == BROKER_REGISTER ) {
+                        finished[ index ].pid = 0;
+                    }
+                    else {
+                        reply.result    = ERROR_NONE;
+                        reply.exit_code = finished[ index ].exit_code;
+                        finished[ index ].queried = TRUE;
+                    }
+                }
+            }
+
+            //start tracking a new console
+            if(
+                ( request.command == BROKER_REGISTER )
+                &&
+                ( reply.result == ERROR_UNTRACKED )
+            ) {
+                if( count >= BROKER_MAX_TRACKED ) {
+                    reply.result = ERROR_BROKER_FULL;
+                }
+                else {
+                    handles[ count + 1 ] = OpenProcess(
+                        SYNCHRONIZE | PROCESS_QUERY_INFORMATION,
+                        FALSE,
+                        request.pid
+                    );
+                    if( handles[ count + 1 ] == NULL ) {
+                        reply.result = ERROR_API_RESULT;
+                    }
+                    else {
+                        count += 1;
+                        pids[ count ]   = request.pid;
+                        reply.result    = ERROR_NONE;
+                        reply.running   = 1;
+                        reply.exit_code = STILL_ACTIVE;
+                    }
+                }
+            }
+
+            pipe_transfer( pipe, &reply, sizeof( reply ), TRUE );
+        }
+
+        //release the client
+        FlushFileBuffers( pipe );
+        DisconnectNamedPipe( pipe );
+    }
+
+    //release anything still being watched
+    for( index = 1; index <= count; ++index ) {
+        CloseHandle( handles[ index ] );
+    }
+    CloseHandle( overlapped.hEvent );
+    CloseHandle( pipe );
+
+    //return success
+    return 0;
+}
+
+
+/*=========================================================================*/
+static error_t pipe_name(           //builds the broker's pipe name
+    LPTSTR              name        //pipe name output (NAME_SIZE)
+) {                                 //error code (0 = no error)
+
+    //local variables
+    DWORD               session;    //ID of the current logon session
+    HRESULT             str_result; //result of string calls
+
+    //each logon session gets its own broker
+    if( ProcessIdToSessionId( GetCurrentProcessId(), &session ) == FALSE ) {
+        return ERROR_API_RESULT;
+    }
+
+    str_result = StringCchPrintf(
+        name,
+        NAME_SIZE,
+        _T( "\\\\.\\pipe\\cygassoc-broker-%lu" ),
+        session
+    );
+
+    //return the result of formatting the name
+    return ( str_result == S_OK ) ? ERROR_NONE : ERROR_API_RESULT;
+}
+
+
+/*=========================================================================*/
+static BOOL pipe_transfer(          //reads or writes one pipe message
+    HANDLE              pipe,       //overlapped pipe handle
+    void*               buffer,     //message buffer
+    DWORD               size,       //size of the message
+    BOOL                write       //TRUE to write, FALSE to read
+) {                                 //TRUE if the whole message moved
+
+    //local variables
+    DWORD               count;      //bytes transferred
+    OVERLAPPED          overlapped; //state of the transfer
+    BOOL                win_result; //result of Win32 calls
+
+    //initialize the transfer state
+    memset( &overlapped, 0, sizeof( overlapped ) );
+    overlapped.hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+
+    if( overlapped.hEvent == NULL ) {
+        return FALSE;
+    }
+
+    //start the transfer
+    if( write == TRUE ) {
+        win_result = WriteFile( pipe, buffer, size, NULL, &overlapped );
+    }
+    else {
+        win_result = ReadFile( pipe, buffer, size, NULL, &overlapped );
+    }
+
+    //a client that stalls is not waited on forever
+    if( ( win_result == FALSE ) && ( GetLastError() == ERROR_IO_PENDING ) ) {
+        if(
+            WaitForSingleObject( overlapped.hEvent, BROKER_TIMEOUT )
+            !=
+            WAIT_OBJECT_0
+        ) {
+            CancelIo( pipe );
+        }
+        win_result = TRUE;
+    }
+
+    //collect the result of the transfer
+    if( win_result == TRUE ) {
+        win_result = GetOverlappedResult( pipe, &overlapped, &count, TRUE );
+        if( ( win_result == TRUE ) && ( count != size ) ) {
+            win_result = FALSE;
+        }
+    }
+
+    //release the transfer event
+    CloseHandle( overlapped.hEvent );
+
+    //return the result of the transfer
+    return win_result;
+}
+
+
+/*=========================================================================*/
+static int record_slot(             //selects a record to replace
+    const broker_record_t*
+                        records     //finished console records
+) {                                 //index of the record
+
+    //local variables
+    DWORD               age;        //time since a console exited (ms)
+    int                 index;      //record index
+    DWORD               now;        //current tick count
+    DWORD               oldest;     //age of the selected record (ms)
+    int                 slot;       //index of the selected record
+
+    //use an unused record, or else replace the oldest record (preferring
+    //  those that have been asked for)
+    now    = GetTickCount();
+    slot   = 0;
+    oldest = 0;
+    for( index = 0; index < BROKER_MAX_FINISHED; ++index ) {
+        if( records[ index ].pid == 0 ) {
+            return index;
+        }
+        age = now - records[ index ].finished;
+        if(
+            ( records[ index ].queried && !records[ slot ].queried )
+            ||
+            (
+                ( records[ index ].queried == records[ slot ].queried )
+                &&
+                ( age > oldest )
+            )
+        ) {
+            slot   = index;
+            oldest = age;
+        }
+    }
+
+    //return the index of the selected record
+    return slot;
+}
+
+
+/*=========================================================================*/
+static BOOL records_pending(        //checks for exit codes not asked for
+    const broker_record_t*
+                        records     //finished console records
+) {                                 //TRUE if any should still be kept
+
+    //local variables
+    int                 index;      //record index
+    DWORD               now;        //current tick count
+
+    //exit codes are kept until asked for, or until they expire
+    now = GetTickCount();
+    for( index = 0; index < BROKER_MAX_FINISHED; ++index ) {
+        if(
+            ( records[ index ].pid != 0 )
+            &&
+            ( records[ index ].queried == FALSE )
+            &&
+            ( ( now - records[ index ].finished ) < BROKER_RETENTION )
+        ) {
+            return TRUE;
+        }
+    }
+
+    //return that nothing needs to be kept
+    return FALSE;
+}
+
+
+/*=========================================================================*/
+static error_t start_broker(        //starts a broker process
+    void
+) {                                 //error code (0 = no error)
+
+    //local variables
+    static TCHAR        command[ IMAGE_SIZE + NAME_SIZE ];
+                                    //broker command string
+    static TCHAR        directory[ MAX_PATH ];
+                                    //broker's working directory
+    DWORD               flags;      //process creation flags
+    static TCHAR        image[ IMAGE_SIZE ];
+                                    //path to this program
+    DWORD               length;     //length of a returned path
+    PROCESS_INFORMATION proc_info;  //broker process information
+    STARTUPINFO         start_info; //broker process startup information
+    HRESULT             str_result; //result of string calls
+    BOOL                win_result; //result of Win32 calls
+
+    //the broker is this same program
+    length = GetModuleFileName( NULL, image, IMAGE_SIZE );
+
+    if( ( length == 0 ) || ( length >= IMAGE_SIZE ) ) {
+        return ERROR_API_RESULT;
+    }
+
+    str_result = StringCchPrintf(
+        command,
+        ( IMAGE_SIZE + NAME_SIZE ),
+        _T( "\"%s\" %ls" ),
+        image,
+        BROKER_SERVE_ARG
+    );
+
+    if( str_result != S_OK ) {
+        return ERROR_API_RESULT;
+    }
+
+    //the broker runs for up to a day, so it must not hold the launcher's
+    //  working directory open (that would keep it from being removed)
+    length = GetSystemDirectory( directory, MAX_PATH );
+
+    if( ( length == 0 ) || ( length >= MAX_PATH ) ) {
+        return ERROR_API_RESULT;
+    }
+
+    //initialize local variables
+    memset( &proc_info,  0, sizeof( proc_info )  );
+    memset( &start_info, 0, sizeof( start_info ) );
+    start_info.cb = sizeof( start_info );
+
+    //create the broker process (it outlives this one, so it leaves any job
+    //  the launcher is in, unless the job does not allow that)
+    flags = CREATE_BREAKAWAY_FROM_JOB;
+    for( ; ; ) {
+        win_result = CreateProcess(
+            NULL,
+            command,
+            NULL,
+            NULL,
+            FALSE,
+            flags,
+            NULL,
+            directory,
+            &start_info,
+            &proc_info
+        );
+        if(
+            ( win_result != FALSE )
+            ||
+            ( flags == 0 )
+            ||
+            ( GetLastError() != ERROR_ACCESS_DENIED )
+        ) {
+            break;
+        }
+        flags = 0;
+    }
+
+    if( win_result == FALSE ) {
+        return ERROR_API_RESULT;
+    }
+
+    //the broker is not waited on
+    CloseHandle( proc_info.hProcess );
+    CloseHandle( proc_info.hThread );
+
+    //return success
+    return ERROR_NONE;
+}
+
+
+/*=========================================================================*/
+static error_t transact(            //sends a request to the broker
+    broker_request_t*   request,    //request to send
+    broker_reply_t*     reply,      //reply from the broker
+    BOOL*               running     //set if a broker was reached
+) {                                 //error code (0 = no error)
+
+    //local variables
+    DWORD               length;     //length of the reply
+    TCHAR               name[ NAME_SIZE ];
+                                    //name of the broker's pipe
+    BOOL                win_result; //result of Win32 calls
+
+    //assume there's no broker until one answers
+    *running = FALSE;
+
+    if( pipe_name( name ) != ERROR_NONE ) {
+        return ERROR_API_RESULT;
+    }
+
+    //connect, send the request, read the reply, and disconnect
+    win_result = CallNamedPipe(
+        name,
+        request,
+        sizeof( broker_request_t ),
+        reply,
+        sizeof( broker_reply_t ),
+        &length,
+        BROKER_TIMEOUT
+    );
+
+    if( win_result == FALSE ) {
+        if( GetLastError() != ERROR_FILE_NOT_FOUND ) {
+            *running = TRUE;
+        }
+        return ERROR_API_RESULT;
+    }
+
+    *running = TRUE;
+
+    //return the result of the transaction
+    return ( length == sizeof( broker_reply_t ) )
+        ? ERROR_NONE : ERROR_API_RESULT;
+}
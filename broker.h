@@ -0,0 +1,65 @@
+/*****************************************************************************
+
+broker.h
+
+Console exit status broker interface declarations.
+
+*****************************************************************************/
+
+#ifndef _BROKER_H
+#define _BROKER_H
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <windows.h>
+#include <tchar.h>
+#include <stdlib.h>
+
+#include "error.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+#define BROKER_SERVE_ARG  L"--broker"
+                                    //argument that runs the broker
+#define BROKER_STATUS_ARG L"--status"
+                                    //argument that queries the broker
+
+#define BROKER_STATUS_UNTRACKED ( 0xE0000001 )
+                                    //--status exit: console is not known
+#define BROKER_STATUS_USAGE ( 0xE0000002 )
+                                    //--status exit: no valid process ID
+#define BROKER_STATUS_ERROR ( 0xE0000003 )
+                                    //--status exit: broker can't be asked
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Interface Prototypes
+----------------------------------------------------------------------------*/
+
+error_t broker_query(               //asks the broker for a console's status
+    DWORD               pid,        //process ID of the console
+    BOOL*               running,    //set if the console is still running
+    DWORD*              exit_code   //exit code (if the console exited)
+);                                  //error code (0 = no error)
+
+error_t broker_register(            //hands a console over to the broker
+    HANDLE              process     //handle to the console process
+);                                  //error code (0 = no error)
+
+int broker_serve(                   //runs the broker until it is idle
+    void
+);                                  //program exit status
+
+
+#endif  /* _BROKER_H */
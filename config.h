@@ -11,6 +11,8 @@ adjust the following options:
 - The console to use and its options
 - The shell to use and its options
 - The Cygwin program that is started within the shell and its options
+- How long to wait on helper programs (cygpath)
+- Whether the program stays running for as long as the console does
 
 *****************************************************************************/
 
@@ -48,6 +50,24 @@ set up the Cygwin-side paths/options.
                                     //the target program to run
 #define CONFIG_TARGET_OPTIONS ""    //options for the target program
 
+/*----------------------------------------------------------
+Helper programs (cygpath) are given a deadline so a stalled
+child can not hang the launch.
+----------------------------------------------------------*/
+#define CONFIG_CYGPATH_TIMEOUT ( 5000 )
+                                    //cygpath time limit (milliseconds)
+
+/*----------------------------------------------------------
+In detached mode, the program exits as soon as the console
+has started, rather than waiting to forward its exit code.
+The program then exits with 0 (--pid-file reports the
+console's process ID), and the console's exit status is
+kept by a single, shared broker process (see broker.c).
+----------------------------------------------------------*/
+#define CONFIG_DETACHED       ( 0 ) //1 = exit once the console has started
+#define CONFIG_START_TIMEOUT  ( 5000 )
+                                    //console start time limit (milliseconds)
+
 /*----------------------------------------------------------------------------
 Macros
 ----------------------------------------------------------------------------*/
@@ -28,7 +28,14 @@ enum {                              //path translation error codes
     ERROR_UNKNOWN = -1023,          //non-specific error (lazy developer)
     ERROR_USAGE,                    //interface usage error
     ERROR_API_RESULT,               //API returned unfavorable result
-    ERROR_ALLOC                     //memory allocation error
+    ERROR_ALLOC,                    //memory allocation error
+    ERROR_CHILD_TIMEOUT,            //child process missed its deadline
+    ERROR_CHILD_EXIT,               //child process exited with failure
+    ERROR_OUTPUT_SIZE,              //output does not fit in given buffer
+    ERROR_LINK_DEPTH,               //too many links followed for a path
+    ERROR_UNTRACKED,                //process is not known to the broker
+    ERROR_BROKER_FULL,              //broker can not track more processes
+    ERROR_LINK_FORMAT               //link file contents are malformed
 };
 
 /*----------------------------------------------------------------------------
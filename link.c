@@ -0,0 +1,668 @@
+/*****************************************************************************
+
+link.c
+
+Resolution of Cygwin symlink files and Windows shortcut (.lnk) files to the
+paths they refer to.  Resolved links are remembered in a small, per-user
+cache file (keyed by the link's path and its last modification time) so a
+link is only parsed again, by later launches, if it changes.
+
+*****************************************************************************/
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <windows.h>
+#include <tchar.h>
+#include <objbase.h>
+#include <shlobj.h>
+#include <strsafe.h>
+
+#include "error.h"
+#include "link.h"
+#include "linkcache.h"
+#include "symlink.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+#define PATH_SIZE ( 512 )           //size of internal path buffers
+
+#define LINK_MAX_DEPTH ( 8 )        //most links followed for one path
+
+#define LINK_CACHE_ROOT _T( "LOCALAPPDATA" )
+                                    //variable naming the cache directory
+
+#define LINK_CACHE_FILE _T( "\\cygassoc-links.dat" )
+                                    //name of the cache file
+
+#define SYMLINK_READ_SIZE \
+    ( SYMLINK_COOKIE_SIZE + ( ( PATH_SIZE + 1 ) * sizeof( WCHAR ) ) )
+                                    //most bytes read from a symlink file
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Module Variables
+----------------------------------------------------------------------------*/
+
+static link_cache_t     link_cache; //recently resolved links
+static BOOL             link_cache_dirty = FALSE;
+                                    //cache must be written back
+static BOOL             link_cache_loaded = FALSE;
+                                    //cache file has been read
+
+/*----------------------------------------------------------------------------
+Module Prototypes
+----------------------------------------------------------------------------*/
+
+static error_t cache_file_name(     //builds the path to the cache file
+    LPTSTR              name,       //path output
+    size_t              size        //size of output string
+);                                  //error code (0 = no error)
+
+static void cache_load(             //reads the cache file (once)
+    void
+);
+
+static void cache_save(             //writes the cache file, if changed
+    void
+);
+
+static error_t copy_wide(           //copies a wide string to a TCHAR string
+    LPTSTR              output,     //destination string
+    size_t              size,       //size of destination string
+    LPCWSTR             input       //source string
+);                                  //length of output or error
+
+static error_t read_shortcut(       //reads the target of a Windows shortcut
+    LPTSTR              target,     //target path output
+    size_t              size,       //size of output string
+    LPCTSTR             path        //path to the shortcut file
+);                                  //length of output or error
+
+static error_t read_symlink(        //reads the target of a Cygwin symlink
+    LPTSTR              target,     //target path output
+    size_t              size,       //size of output string
+    LPCTSTR             path,       //path to the symlink file
+    BOOL*               final       //set if the target is a POSIX path
+);                                  //length of output or error (0 = none)
+
+static error_t resolve_once(        //resolves one level of linking
+    LPTSTR              target,     //target path output
+    size_t              size,       //size of output string
+    LPCTSTR             path,       //path that may be a link
+    BOOL*               final       //set if the target is a POSIX path
+);                                  //length of output or error (0 = none)
+
+
+/*==========================================================================*/
+error_t resolve_link(               //resolves symlinks and shortcuts
+    LPTSTR              target,     //resolved path output
+    size_t              size,       //size of output string
+    LPCTSTR             path        //path that may be a link
+) {                                 //length of output or error
+
+    //local variables
+    int                 depth;      //number of links followed
+    BOOL                final;      //target is not to be resolved further
+    static TCHAR        next[ PATH_SIZE ];
+                                    //path one link further along
+    error_t             result;     //resulting string length/error
+    error_t             step;       //result of resolving one link
+    HRESULT             str_result; //result of string calls
+
+    //check input
+    if( ( target == NULL ) || ( size < 1 ) || ( path == NULL ) ) {
+        return ERROR_USAGE;
+    }
+
+    //start from the given path (on failure, the target is left holding the
+    //  last path that was reached, or nothing if the path does not fit)
+    str_result = StringCchCopy( target, size, path );
+
+    if( str_result != S_OK ) {
+        target[ 0 ] = 0;
+        return ERROR_OUTPUT_SIZE;
+    }
+
+    //follow links until a path is not a link
+    cache_load();
+    result = ERROR_LINK_DEPTH;
+    for( depth = 0; depth < LINK_MAX_DEPTH; ++depth ) {
+
+        //resolve the current path by one link
+        final = FALSE;
+        step  = resolve_once( next, PATH_SIZE, target, &final );
+
+        //stop on errors
+        if( step < ERROR_NONE ) {
+            result = step;
+            break;
+        }
+
+        //not a link, the current path is the final target
+        if( step == 0 ) {
+            result = _tcslen( target );
+            break;
+        }
+
+        //move along to the link's target
+        if( ( size_t ) step >= size ) {
+            result = ERROR_OUTPUT_SIZE;
+            break;
+        }
+        StringCchCopy( target, size, next );
+
+        //POSIX targets can only be followed further by Cygwin itself
+        if( final == TRUE ) {
+            result = step;
+            break;
+        }
+    }
+
+    //keep anything newly resolved for later launches
+    cache_save();
+
+    //return the length of the target (or the error that stopped resolution)
+    return result;
+}
+
+
+/*=========================================================================*/
+static error_t cache_file_name(     //builds the path to the cache file
+    LPTSTR              name,       //path output
+    size_t              size        //size of output string
+) {                                 //error code (0 = no error)
+
+    //local variables
+    DWORD               length;     //length of the cache directory
+    HRESULT             str_result; //result of string calls
+
+    //the cache lives in the user's local application data
+    length = GetEnvironmentVariable( LINK_CACHE_ROOT, name, ( DWORD ) size );
+
+    if( ( length == 0 ) || ( length >= size ) ) {
+        return ERROR_API_RESULT;
+    }
+
+    str_result = StringCchCat( name, size, LINK_CACHE_FILE );
+
+    //return the result of building the name
+    return ( str_result == S_OK ) ? ERROR_NONE : ERROR_OUTPUT_SIZE;
+}
+
+
+/*=========================================================================*/
+static void cache_load(             //reads the cache file (once)
+    void
+) {
+
+    //local variables
+    HANDLE              file;       //handle to the cache file
+    DWORD               length;     //number of bytes read
+    TCHAR               name[ PATH_SIZE ];
+                                    //path to the cache file
+    BOOL                win_result; //result of Win32 calls
+
+    //only read the file once per launch
+    if( link_cache_loaded == TRUE ) {
+        return;
+    }
+    link_cache_loaded = TRUE;
+    link_cache_reset( &link_cache );
+
+    //a missing or unreadable cache is simply empty
+    if( cache_file_name( name, PATH_SIZE ) != ERROR_NONE ) {
+        return;
+    }
+
+    file = CreateFile(
+        name,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL
+    );
+
+    if( file == INVALID_HANDLE_VALUE ) {
+        return;
+    }
+
+    win_result = ReadFile(
+        file,
+        &link_cache,
+        sizeof( link_cache ),
+        &length,
+        NULL
+    );
+    CloseHandle( file );
+
+    //discard caches from other builds (or that are damaged)
+    if(
+        ( win_result == FALSE )
+        ||
+        ( length != sizeof( link_cache ) )
+        ||
+        ( link_cache_valid( &link_cache ) == 0 )
+    ) {
+        link_cache_reset( &link_cache );
+    }
+}
+
+
+/*=========================================================================*/
+static void cache_save(             //writes the cache file, if changed
+    void
+) {
+
+    //local variables
+    HANDLE              file;       //handle to the new cache file
+    DWORD               length;     //number of bytes written
+    TCHAR               name[ PATH_SIZE ];
+                                    //path to the cache file
+    HRESULT             str_result; //result of string calls
+    TCHAR               temp[ PATH_SIZE ];
+                                    //path to the new cache file
+    BOOL                win_result; //result of Win32 calls
+
+    //only write a cache that changed
+    if( link_cache_dirty == FALSE ) {
+        return;
+    }
+    link_cache_dirty = FALSE;
+
+    //write a new file, then replace the old one with it so concurrent
+    //  launches never read a partial cache (the last writer wins)
+    if( cache_file_name( name, PATH_SIZE ) != ERROR_NONE ) {
+        return;
+    }
+
+    str_result = StringCchPrintf(
+        temp,
+        PATH_SIZE,
+        _T( "%s.%lu" ),
+        name,
+        GetCurrentProcessId()
+    );
+
+    if( str_result != S_OK ) {
+        return;
+    }
+
+    file = CreateFile(
+        temp,
+        GENERIC_WRITE,
+        0,
+        NULL,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL
+    );
+
+    if( file == INVALID_HANDLE_VALUE ) {
+        return;
+    }
+
+    win_result = WriteFile(
+        file,
+        &link_cache,
+        sizeof( link_cache ),
+        &length,
+        NULL
+    );
+    CloseHandle( file );
+
+    if(
+        ( win_result == FALSE )
+        ||
+        ( length != sizeof( link_cache ) )
+        ||
+        ( MoveFileEx( temp, name, MOVEFILE_REPLACE_EXISTING ) == FALSE )
+    ) {
+        DeleteFile( temp );
+    }
+}
+
+
+/*=========================================================================*/
+static error_t copy_wide(           //copies a wide string to a TCHAR string
+    LPTSTR              output,     //destination string
+    size_t              size,       //size of destination string
+    LPCWSTR             input       //source string
+) {                                 //length of output or error
+
+    //local variables
+    #ifndef UNICODE
+    int                 conv_result;//result of string conversion
+    #else
+    HRESULT             str_result; //result of string calls
+    #endif
+
+    //wide strings are copied directly
+    #ifdef UNICODE
+
+        str_result = StringCchCopyW( output, size, input );
+
+        if( str_result != S_OK ) {
+            return ERROR_OUTPUT_SIZE;
+        }
+
+    //multi-byte strings must be converted
+    #else
+
+        conv_result = WideCharToMultiByte(
+            CP_ACP,                 //use context's codepage
+            0,                      //default conversion settings
+            input,                  //source string to convert
+            -1,                     //source string is terminated
+            output,                 //conversion destination memory
+            ( int ) size,           //size of destination memory
+            NULL,                   //use system default character
+            NULL                    //defaulting is not reported
+        );
+
+        if( conv_result <= 0 ) {
+            return ( GetLastError() == ERROR_INSUFFICIENT_BUFFER )
+                ? ERROR_OUTPUT_SIZE : ERROR_API_RESULT;
+        }
+
+    #endif
+
+    //return the length of the copied string
+    return _tcslen( output );
+}
+
+
+/*=========================================================================*/
+static error_t read_shortcut(       //reads the target of a Windows shortcut
+    LPTSTR              target,     //target path output
+    size_t              size,       //size of output string
+    LPCTSTR             path        //path to the shortcut file
+) {                                 //length of output or error
+
+    //local variables
+    HRESULT             com_result; //result of COM calls
+    HRESULT             init_result;//result of COM initialization
+    IPersistFile*       file;       //shortcut's file interface
+    IShellLink*         link;       //shortcut's link interface
+    error_t             result;     //resulting string length/error
+    #ifdef UNICODE
+    LPCWSTR             wide_path;  //path in wide characters
+    #else
+    WCHAR               wide_path[ PATH_SIZE ];
+                                    //path in wide characters
+    #endif
+
+    //the file interface only loads wide-character paths
+    #ifdef UNICODE
+        wide_path = path;
+    #else
+        if(
+            MultiByteToWideChar(
+                CP_ACP, 0, path, -1, wide_path, PATH_SIZE
+            ) <= 0
+        ) {
+            return ERROR_API_RESULT;
+        }
+    #endif
+
+    //the shell link object is provided through COM
+    init_result = CoInitializeEx(
+        NULL,
+        COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE
+    );
+
+    if( FAILED( init_result ) ) {
+        return ERROR_API_RESULT;
+    }
+
+    //create a shell link object
+    com_result = CoCreateInstance(
+        &CLSID_ShellLink,
+        NULL,
+        CLSCTX_INPROC_SERVER,
+        &IID_IShellLink,
+        ( void** ) &link
+    );
+
+    if( FAILED( com_result ) ) {
+        CoUninitialize();
+        return ERROR_API_RESULT;
+    }
+
+    //load the shortcut file through the link's file interface
+    result     = ERROR_API_RESULT;
+    com_result = link->lpVtbl->QueryInterface(
+        link,
+        &IID_IPersistFile,
+        ( void** ) &file
+    );
+
+    if( SUCCEEDED( com_result ) ) {
+
+        com_result = file->lpVtbl->Load( file, wide_path, STGM_READ );
+
+        //fetch the file system path the shortcut refers to
+        if( SUCCEEDED( com_result ) ) {
+            com_result = link->lpVtbl->GetPath(
+                link,
+                target,
+                ( int ) size,
+                NULL,
+                0
+            );
+
+            //shortcuts to non-file items have no path to open
+            if( com_result == S_OK ) {
+                result = _tcslen( target );
+            }
+            else if( SUCCEEDED( com_result ) ) {
+                result = 0;
+            }
+        }
+
+        file->lpVtbl->Release( file );
+    }
+
+    //release the link object and COM
+    link->lpVtbl->Release( link );
+    CoUninitialize();
+
+    //return the length of the target path
+    return result;
+}
+
+
+/*=========================================================================*/
+static error_t read_symlink(        //reads the target of a Cygwin symlink
+    LPTSTR              target,     //target path output
+    size_t              size,       //size of output string
+    LPCTSTR             path,       //path to the symlink file
+    BOOL*               final       //set if the target is a POSIX path
+) {                                 //length of output or error (0 = none)
+
+    //local variables
+    static BYTE         content[ SYMLINK_READ_SIZE ];
+                                    //contents of the symlink file
+    HANDLE              file;       //handle to the symlink file
+    static symlink_char_t
+                        joined[ PATH_SIZE ];
+                                    //target joined to the link's directory
+    DWORD               length;     //number of bytes read from the file
+    static symlink_char_t
+                        link_target[ PATH_SIZE ];
+                                    //target stored in the symlink
+    error_t             result;     //resulting string length/error
+    #ifdef UNICODE
+    LPCWSTR             wide_path;  //path in wide characters
+    #else
+    static WCHAR        wide_path[ PATH_SIZE ];
+                                    //path in wide characters
+    #endif
+    BOOL                win_result; //result of Win32 calls
+
+    //read the start of the file
+    file = CreateFile(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL
+    );
+
+    if( file == INVALID_HANDLE_VALUE ) {
+        return ERROR_API_RESULT;
+    }
+
+    win_result = ReadFile( file, content, SYMLINK_READ_SIZE, &length, NULL );
+    CloseHandle( file );
+
+    if( win_result == FALSE ) {
+        return ERROR_API_RESULT;
+    }
+
+    //decode the target (system files without the marker are not links)
+    result = symlink_parse( link_target, PATH_SIZE, content, length );
+
+    if( result <= 0 ) {
+        return result;
+    }
+
+    //POSIX-absolute targets are left for cygpath to translate
+    if( symlink_is_absolute( link_target ) ) {
+        *final = TRUE;
+        return copy_wide( target, size, ( LPCWSTR ) link_target );
+    }
+
+    //relative targets are relative to the symlink's directory
+    #ifdef UNICODE
+        wide_path = path;
+    #else
+        if(
+            MultiByteToWideChar(
+                CP_ACP, 0, path, -1, wide_path, PATH_SIZE
+            ) <= 0
+        ) {
+            return ERROR_API_RESULT;
+        }
+    #endif
+
+    result = symlink_join(
+        joined,
+        PATH_SIZE,
+        ( const symlink_char_t* ) wide_path,
+        link_target
+    );
+
+    if( result < ERROR_NONE ) {
+        return result;
+    }
+
+    //return the length of the target path
+    return copy_wide( target, size, ( LPCWSTR ) joined );
+}
+
+
+/*=========================================================================*/
+static error_t resolve_once(        //resolves one level of linking
+    LPTSTR              target,     //target path output
+    size_t              size,       //size of output string
+    LPCTSTR             path,       //path that may be a link
+    BOOL*               final       //set if the target is a POSIX path
+) {                                 //length of output or error (0 = none)
+
+    //local variables
+    WIN32_FILE_ATTRIBUTE_DATA attrs;//file system attributes of the path
+    const link_entry_t* entry;      //cache entry for the path
+    LPCTSTR             extension;  //file name extension of the path
+    size_t              length;     //length of the path
+    unsigned long long  mtime;      //link's last modification time
+    error_t             result;     //resulting string length/error
+    HRESULT             str_result; //result of string calls
+
+    //paths that can not be inspected (e.g. new files) are not links
+    if( GetFileAttributesEx( path, GetFileExInfoStandard, &attrs ) == 0 ) {
+        return 0;
+    }
+
+    if( ( attrs.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) != 0 ) {
+        return 0;
+    }
+
+    //only shortcuts and system files (Cygwin symlinks) are links
+    length    = _tcslen( path );
+    extension = ( length > 4 ) ? ( path + length - 4 ) : path;
+
+    if(
+        ( lstrcmpi( extension, _T( ".lnk" ) ) != 0 )
+        &&
+        ( ( attrs.dwFileAttributes & FILE_ATTRIBUTE_SYSTEM ) == 0 )
+    ) {
+        return 0;
+    }
+
+    //check for an unchanged link that has already been resolved
+    mtime = ( ( unsigned long long ) attrs.ftLastWriteTime.dwHighDateTime
+        << 32 ) | attrs.ftLastWriteTime.dwLowDateTime;
+    entry = link_cache_find(
+        &link_cache,
+        ( const link_cache_char_t* ) path,
+        mtime
+    );
+
+    if( entry != NULL ) {
+        str_result = StringCchCopy(
+            target,
+            size,
+            ( LPCTSTR ) entry->target
+        );
+        if( str_result != S_OK ) {
+            return ERROR_OUTPUT_SIZE;
+        }
+        *final = ( entry->final != 0 ) ? TRUE : FALSE;
+        return _tcslen( target );
+    }
+
+    //parse the link
+    if( lstrcmpi( extension, _T( ".lnk" ) ) == 0 ) {
+        result = read_shortcut( target, size, path );
+    }
+    else {
+        result = read_symlink( target, size, path, final );
+    }
+
+    //errors are not remembered so that they are retried
+    if( result < ERROR_NONE ) {
+        return result;
+    }
+
+    //remember the link (or lack of one) if it fits in the cache
+    if(
+        link_cache_store(
+            &link_cache,
+            ( const link_cache_char_t* ) path,
+            mtime,
+            ( const link_cache_char_t* )
+                ( ( result > 0 ) ? target : _T( "" ) ),
+            *final
+        ) != 0
+    ) {
+        link_cache_dirty = TRUE;
+    }
+
+    //return the length of the target path
+    return result;
+}
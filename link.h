@@ -0,0 +1,46 @@
+/*****************************************************************************
+
+link.h
+
+Cygwin symlink and Windows shortcut resolution interface declarations.
+
+*****************************************************************************/
+
+#ifndef _LINK_H
+#define _LINK_H
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <windows.h>
+#include <tchar.h>
+#include <stdlib.h>
+
+#include "error.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Interface Prototypes
+----------------------------------------------------------------------------*/
+
+error_t resolve_link(               //resolves symlinks and shortcuts
+    LPTSTR              target,     //resolved path output (on error, the
+                                    //  last path reached, or empty)
+    size_t              size,       //size of output string
+    LPCTSTR             path        //path that may be a link
+);                                  //length of output or error
+
+
+#endif  /* _LINK_H */
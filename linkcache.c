@@ -0,0 +1,210 @@
+/*****************************************************************************
+
+linkcache.c
+
+A small table of recently resolved links, keyed by the link's path and its
+last modification time.  link.c keeps the table in a per-user file so that
+later launches only parse a link again if it changes.
+
+Paths are compared without regard to case, as Windows does, but only for
+ASCII letters.  Paths that differ only in the case of other letters are
+looked up as different links, which only costs another parse.
+
+This module only works on plain memory so it can be built and tested without
+Win32.
+
+*****************************************************************************/
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "linkcache.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+#define fold( _c ) \
+    ( ( ( ( _c ) >= 'A' ) && ( ( _c ) <= 'Z' ) ) ? ( ( _c ) + 32 ) : ( _c ) )
+                                    //folds an ASCII letter to lower case
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Module Variables
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Module Prototypes
+----------------------------------------------------------------------------*/
+
+static int path_fits(               //checks that a path fits in an entry
+    const link_cache_char_t*
+                        path        //path to check
+);                                  //non-zero if the path fits
+
+static int same_path(               //compares two paths (ignoring case)
+    const link_cache_char_t*
+                        left,       //first path
+    const link_cache_char_t*
+                        right       //second path
+);                                  //non-zero if the paths are the same
+
+
+/*==========================================================================*/
+const link_entry_t* link_cache_find(//finds an unchanged, resolved link
+    const link_cache_t* cache,      //cache to search
+    const link_cache_char_t*
+                        link,       //path to the link
+    unsigned long long  mtime       //link's last modification time
+) {                                 //entry for the link (NULL = none)
+
+    //local variables
+    int                 index;      //entry index
+
+    //check input
+    if( ( cache == NULL ) || ( link == NULL ) || ( link[ 0 ] == 0 ) ) {
+        return NULL;
+    }
+
+    //a link that changed since it was resolved is not found
+    for( index = 0; index < LINK_CACHE_SIZE; ++index ) {
+        if(
+            ( cache->entries[ index ].mtime == mtime )
+            &&
+            same_path( cache->entries[ index ].link, link )
+        ) {
+            return &cache->entries[ index ];
+        }
+    }
+
+    //the link has not been resolved
+    return NULL;
+}
+
+
+/*==========================================================================*/
+void link_cache_reset(              //empties a cache
+    link_cache_t*       cache       //cache to empty
+) {
+
+    //clear every entry, and mark the cache as belonging to this build
+    memset( cache, 0, sizeof( link_cache_t ) );
+    cache->magic     = LINK_CACHE_MAGIC;
+    cache->char_size = sizeof( link_cache_char_t );
+}
+
+
+/*==========================================================================*/
+int link_cache_store(               //remembers a resolved link
+    link_cache_t*       cache,      //cache to update
+    const link_cache_char_t*
+                        link,       //path to the link
+    unsigned long long  mtime,      //link's last modification time
+    const link_cache_char_t*
+                        target,     //resolved path (empty = not a link)
+    int                 final       //target is not to be resolved further
+) {                                 //non-zero if the link was stored
+
+    //local variables
+    link_entry_t*       entry;      //entry given to the link
+    int                 index;      //entry index
+
+    //check input (paths that don't fit are not remembered)
+    if(
+        ( cache == NULL ) || ( link == NULL ) || ( link[ 0 ] == 0 )
+        ||
+        ( target == NULL )
+        ||
+        ( path_fits( link ) == 0 ) || ( path_fits( target ) == 0 )
+    ) {
+        return 0;
+    }
+
+    //a link that was resolved before (and has changed) keeps its entry,
+    //  others replace the oldest entry
+    entry = &cache->entries[ cache->next ];
+    for( index = 0; index < LINK_CACHE_SIZE; ++index ) {
+        if( same_path( cache->entries[ index ].link, link ) ) {
+            entry = &cache->entries[ index ];
+            break;
+        }
+    }
+    if( entry == &cache->entries[ cache->next ] ) {
+        cache->next = ( cache->next + 1 ) % LINK_CACHE_SIZE;
+    }
+
+    //fill in the entry
+    memset( entry, 0, sizeof( link_entry_t ) );
+    for( index = 0; link[ index ] != 0; ++index ) {
+        entry->link[ index ] = link[ index ];
+    }
+    for( index = 0; target[ index ] != 0; ++index ) {
+        entry->target[ index ] = target[ index ];
+    }
+    entry->mtime = mtime;
+    entry->final = ( final != 0 ) ? 1 : 0;
+
+    //return that the link was stored
+    return 1;
+}
+
+
+/*==========================================================================*/
+int link_cache_valid(               //checks a cache read from a file
+    const link_cache_t* cache       //cache to check
+) {                                 //non-zero if the cache can be used
+
+    //caches from other builds (or that are damaged) are not used
+    return ( cache != NULL )
+        && ( cache->magic == LINK_CACHE_MAGIC )
+        && ( cache->char_size == sizeof( link_cache_char_t ) )
+        && ( cache->next < LINK_CACHE_SIZE );
+}
+
+
+/*=========================================================================*/
+static int path_fits(               //checks that a path fits in an entry
+    const link_cache_char_t*
+                        path        //path to check
+) {                                 //non-zero if the path fits
+
+    //local variables
+    size_t              length;     //length of the path
+
+    //the path and its terminator must fit
+    for( length = 0; path[ length ] != 0; ++length ) {
+        if( ( length + 1 ) >= LINK_CACHE_PATH_SIZE ) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/*=========================================================================*/
+static int same_path(               //compares two paths (ignoring case)
+    const link_cache_char_t*
+                        left,       //first path
+    const link_cache_char_t*
+                        right       //second path
+) {                                 //non-zero if the paths are the same
+
+    //compare each character, including the terminator
+    for( ; *left != 0; ++left, ++right ) {
+        if( fold( *left ) != fold( *right ) ) {
+            return 0;
+        }
+    }
+    return *right == 0;
+}
@@ -0,0 +1,93 @@
+/*****************************************************************************
+
+linkcache.h
+
+Resolved link cache interface declarations.
+
+*****************************************************************************/
+
+#ifndef _LINKCACHE_H
+#define _LINKCACHE_H
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <stdlib.h>
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+#define LINK_CACHE_SIZE ( 16 )      //number of remembered links
+
+#define LINK_CACHE_PATH_SIZE ( 260 )
+                                    //longest path that is remembered
+                                    //  (MAX_PATH)
+
+#define LINK_CACHE_MAGIC ( 0x324E4C43 )
+                                    //marks a cache file ("CLN2")
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+#ifdef UNICODE
+typedef unsigned short link_cache_char_t;
+                                    //path character (the size of TCHAR)
+#else
+typedef char link_cache_char_t;     //path character (the size of TCHAR)
+#endif
+
+typedef struct link_entry_s {       //remembered link resolution
+    link_cache_char_t   link[ LINK_CACHE_PATH_SIZE ];
+                                    //path to the link (empty = unused)
+    unsigned long long  mtime;      //link's last modification time
+    link_cache_char_t   target[ LINK_CACHE_PATH_SIZE ];
+                                    //resolved path (empty = not a link)
+    unsigned int        final;      //target is not to be resolved further
+} link_entry_t;
+
+typedef struct link_cache_s {       //contents of the cache file
+    unsigned int        magic;      //LINK_CACHE_MAGIC
+    unsigned int        char_size;  //sizeof( link_cache_char_t )
+    unsigned int        next;       //next entry to replace
+    link_entry_t        entries[ LINK_CACHE_SIZE ];
+                                    //recently resolved links
+} link_cache_t;
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Interface Prototypes
+----------------------------------------------------------------------------*/
+
+const link_entry_t* link_cache_find(//finds an unchanged, resolved link
+    const link_cache_t* cache,      //cache to search
+    const link_cache_char_t*
+                        link,       //path to the link
+    unsigned long long  mtime       //link's last modification time
+);                                  //entry for the link (NULL = none)
+
+void link_cache_reset(              //empties a cache
+    link_cache_t*       cache       //cache to empty
+);
+
+int link_cache_store(               //remembers a resolved link
+    link_cache_t*       cache,      //cache to update
+    const link_cache_char_t*
+                        link,       //path to the link
+    unsigned long long  mtime,      //link's last modification time
+    const link_cache_char_t*
+                        target,     //resolved path (empty = not a link)
+    int                 final       //target is not to be resolved further
+);                                  //non-zero if the link was stored
+
+int link_cache_valid(               //checks a cache read from a file
+    const link_cache_t* cache       //cache to check
+);                                  //non-zero if the cache can be used
+
+
+#endif  /* _LINKCACHE_H */
@@ -13,19 +13,26 @@ shell.
 Includes
 ----------------------------------------------------------------------------*/
 
+#include <stdarg.h>
 #include <windows.h>
 #include <tchar.h>
 #include <shellapi.h>
 #include <strsafe.h>
 
+#include "broker.h"
 #include "config.h"
 #include "error.h"
+#include "link.h"
 #include "path.h"
 
 /*----------------------------------------------------------------------------
 Macros
 ----------------------------------------------------------------------------*/
 
+#define PID_FILE_ARG L"--pid-file"  //argument naming a process ID file
+
+#define TEXT_SIZE ( 64 )            //size of reported text lines
+
 /*----------------------------------------------------------------------------
 Types and Structures
 ----------------------------------------------------------------------------*/
@@ -47,11 +54,21 @@ static void free_array(             //frees an array of pointed-to things
     int                 count       //number of items in the array
 );
 
+static DWORD query_status(          //reports a detached console's status
+    LPCWSTR             argument    //process ID argument (NULL = missing)
+);                                  //program exit status
+
 static LPSTR* wc2mb_array(          //convert array of strings WC -> MB
     LPCWSTR*            strings,    //wide-character array of string pointers
     int                 count       //number of strings in array
 );                                  //multi-byte array of string pointers
 
+static error_t write_text(          //writes a line of text to a file
+    LPCWSTR             name,       //name of the file ("-" = stdout)
+    LPCSTR              format,     //format of the line
+    ...                             //values to format
+);                                  //error code (0 = no error)
+
 
 /*=========================================================================*/
 int WINAPI WinMain(                 //Windows program entry point
@@ -69,6 +86,10 @@ int WINAPI WinMain(                 //Windows program entry point
     int                 argc;       //number of command line arguments
     LPTSTR*             argv;       //list of command line arguments
     LPWSTR*             arguments;  //list of argument string pointers
+    #if CONFIG_DETACHED
+    error_t             broker_result;
+                                    //error from the status broker
+    #endif
     static TCHAR        command[ BUFFER_SIZE ];
                                     //command to execute
     PROCESS_INFORMATION cp_pr_info; //CreateProcess process info
@@ -78,7 +99,13 @@ int WINAPI WinMain(                 //Windows program entry point
                                     //file path argument
     error_t             path_result;//error from path translation
     DWORD               exit_code;  //exit code of spawned process
+    int                 first;      //index of the file argument
+    LPCWSTR             pid_file;   //file given the console's process ID
+    static WCHAR        pid_name[ BUFFER_SIZE ];
+                                    //name of the process ID file
     HRESULT             str_result; //result of string operations
+    static TCHAR        target[ BUFFER_SIZE ];
+                                    //file path after resolving links
 
     //parse the command line
     arguments = CommandLineToArgvW( GetCommandLineW(), &argc );
@@ -86,8 +113,38 @@ int WINAPI WinMain(                 //Windows program entry point
         return 1;
     }
 
+    //run the status broker instead of a console
+    if( ( argc > 1 ) && ( wcscmp( arguments[ 1 ], BROKER_SERVE_ARG ) == 0 ) ) {
+        LocalFree( arguments );
+        return broker_serve();
+    }
+
+    //ask the status broker for a detached console's exit status
+    if(
+        ( argc > 1 )
+        &&
+        ( wcscmp( arguments[ 1 ], BROKER_STATUS_ARG ) == 0 )
+    ) {
+        exit_code = query_status( ( argc == 3 ) ? arguments[ 2 ] : NULL );
+        LocalFree( arguments );
+        return exit_code;
+    }
+
+    //the console's process ID may be written to a file (or stdout)
+    first    = 1;
+    pid_file = NULL;
+    if( ( argc > 2 ) && ( wcscmp( arguments[ 1 ], PID_FILE_ARG ) == 0 ) ) {
+        str_result = StringCchCopyW( pid_name, BUFFER_SIZE, arguments[ 2 ] );
+        if( str_result != S_OK ) {
+            LocalFree( arguments );
+            return 1;
+        }
+        pid_file = pid_name;
+        first    = 3;
+    }
+
     //see if a file was specified
-    if( argc > 1 ) {
+    if( argc > first ) {
 
         //check for need to convert to ANSI characters
         #ifndef UNICODE
@@ -100,8 +157,17 @@ int WINAPI WinMain(                 //Windows program entry point
             argv = arguments;
         #endif
 
+        //open the target of a symlink or shortcut rather than the link (if
+        //  resolution fails part way, the last link reached is opened)
+        resolve_link( target, BUFFER_SIZE, argv[ first ] );
+
         //translate the file path
-        path_result = cygpath( path, BUFFER_SIZE, argv[ 1 ], PATH_OPT_UNIX );
+        path_result = cygpath(
+            path,
+            BUFFER_SIZE,
+            ( target[ 0 ] == 0 ) ? argv[ first ] : target,
+            PATH_OPT_UNIX
+        );
 
         #ifndef UNICODE
             free_array( ( void** ) argv, argc );
@@ -167,6 +233,24 @@ int WINAPI WinMain(                 //Windows program entry point
 
     //wait for console to finish
     if( cp_result == TRUE ) {
+
+        //report the console's process ID (for --status)
+        if( pid_file != NULL ) {
+            write_text( pid_file, "%lu", cp_pr_info.dwProcessId );
+        }
+
+        //in detached mode, only wait for the console to start, and leave
+        //  its exit status with the broker (waits if the broker fails)
+        #if CONFIG_DETACHED
+            WaitForInputIdle( cp_pr_info.hProcess, CONFIG_START_TIMEOUT );
+            broker_result = broker_register( cp_pr_info.hProcess );
+            if( broker_result == ERROR_NONE ) {
+                CloseHandle( cp_pr_info.hProcess );
+                CloseHandle( cp_pr_info.hThread );
+                return 0;
+            }
+        #endif
+
         WaitForSingleObject( cp_pr_info.hProcess, INFINITE );
         cp_result = GetExitCodeProcess( cp_pr_info.hProcess, &exit_code );
         CloseHandle( cp_pr_info.hProcess );
@@ -209,6 +293,57 @@ static void free_array(             //frees an array of pointed-to things
 }
 
 
+/*=========================================================================*/
+static DWORD query_status(          //reports a detached console's status
+    LPCWSTR             argument    //process ID argument (NULL = missing)
+) {                                 //program exit status
+
+    //local variables
+    LPWSTR              end;        //end of the parsed process ID
+    DWORD               exit_code;  //exit code of the console
+    DWORD               pid;        //process ID of the console
+    error_t             result;     //result of asking the broker
+    BOOL                running;    //the console is still running
+
+    //the process ID must be a whole, non-zero number
+    pid = 0;
+    if( argument != NULL ) {
+        pid = wcstoul( argument, &end, 10 );
+        if( ( end == argument ) || ( *end != 0 ) ) {
+            pid = 0;
+        }
+    }
+
+    if( pid == 0 ) {
+        write_text( L"-", "usage: --status <process ID>" );
+        return BROKER_STATUS_USAGE;
+    }
+
+    //ask the broker (the printed status is never ambiguous, even when the
+    //  console's own exit code is STILL_ACTIVE or a reserved code)
+    result = broker_query( pid, &running, &exit_code );
+
+    if( result == ERROR_UNTRACKED ) {
+        write_text( L"-", "%lu untracked", pid );
+        return BROKER_STATUS_UNTRACKED;
+    }
+
+    if( result != ERROR_NONE ) {
+        write_text( L"-", "%lu unknown (error %ld)", pid, result );
+        return BROKER_STATUS_ERROR;
+    }
+
+    if( running == TRUE ) {
+        write_text( L"-", "%lu running", pid );
+        return STILL_ACTIVE;
+    }
+
+    //return the console's exit code
+    write_text( L"-", "%lu exited %lu", pid, exit_code );
+    return exit_code;
+}
+
+
 /*=========================================================================*/
 static char** wc2mb_array(          //convert array of strings WC -> MB
     LPCWSTR*            strings,    //wide-character array of string pointers
@@ -281,3 +416,61 @@ static char** wc2mb_array(          //convert array of strings WC -> MB
     return result;
 }
 
+
+/*=========================================================================*/
+static error_t write_text(          //writes a line of text to a file
+    LPCWSTR             name,       //name of the file ("-" = stdout)
+    LPCSTR              format,     //format of the line
+    ...                             //values to format
+) {                                 //error code (0 = no error)
+
+    //local variables
+    va_list             args;       //values to format
+    HANDLE              file;       //handle to the file
+    DWORD               length;     //number of bytes written
+    HRESULT             str_result; //result of string operations
+    char                text[ TEXT_SIZE ];
+                                    //formatted line
+    BOOL                win_result; //result of Win32 calls
+
+    //format the line
+    va_start( args, format );
+    str_result = StringCchVPrintfA( text, ( TEXT_SIZE - 1 ), format, args );
+    va_end( args );
+
+    if( str_result != S_OK ) {
+        return ERROR_OUTPUT_SIZE;
+    }
+    StringCchCatA( text, TEXT_SIZE, "\n" );
+
+    //a window program only has a stdout if the caller redirected it
+    if( wcscmp( name, L"-" ) == 0 ) {
+        file = GetStdHandle( STD_OUTPUT_HANDLE );
+        if( ( file == NULL ) || ( file == INVALID_HANDLE_VALUE ) ) {
+            return ERROR_API_RESULT;
+        }
+    }
+    else {
+        file = CreateFileW(
+            name,
+            GENERIC_WRITE,
+            FILE_SHARE_READ,
+            NULL,
+            CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL,
+            NULL
+        );
+        if( file == INVALID_HANDLE_VALUE ) {
+            return ERROR_API_RESULT;
+        }
+    }
+
+    win_result = WriteFile( file, text, strlen( text ), &length, NULL );
+
+    if( wcscmp( name, L"-" ) != 0 ) {
+        CloseHandle( file );
+    }
+
+    //return the result of writing the line
+    return ( win_result == TRUE ) ? ERROR_NONE : ERROR_API_RESULT;
+}
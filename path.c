@@ -17,6 +17,7 @@ Includes
 #include "config.h"
 #include "error.h"
 #include "path.h"
+#include "stream.h"
 
 /*----------------------------------------------------------------------------
 Macros
@@ -27,10 +28,17 @@ Macros
 #define select_mode( _o ) path_options[ ( _o ) & MODE_MASK ]
                                     //selects the proper mode option
 
+#define PIPE_BUFFER_SIZE ( 4096 )   //size of the pipe's internal buffer
+
 /*----------------------------------------------------------------------------
 Types and Structures
 ----------------------------------------------------------------------------*/
 
+typedef struct pipe_stream_s {      //overlapped pipe read state
+    HANDLE              handle;     //read-end of pipe (overlapped)
+    OVERLAPPED          overlapped; //state of the pending read
+} pipe_stream_t;
+
 /*----------------------------------------------------------------------------
 Memory Constants
 ----------------------------------------------------------------------------*/
@@ -51,7 +59,25 @@ Module Variables
 Module Prototypes
 ----------------------------------------------------------------------------*/
 
+static error_t create_pipe(         //creates an overlapped stdout pipe
+    HANDLE*             read_pipe,  //read-end of pipe (overlapped)
+    HANDLE*             write_pipe  //write-end of pipe (inheritable)
+);                                  //error code (0 = no error)
+
+static unsigned long pipe_clock(    //reads the system tick count
+    void*               context     //pipe stream state (unused)
+);                                  //current tick count
+
+static error_t pipe_read(           //reads what is available before a limit
+    void*               context,    //pipe stream state
+    char*               buffer,     //destination of output
+    unsigned long       size,       //size of destination
+    unsigned long       timeout,    //time limit (milliseconds)
+    unsigned long*      count       //bytes read (0 = end of stream)
+);                                  //error code (0 = no error)
+
 static error_t run_cygpath(         //runs cygpath with a given output handle
+    HANDLE*             process,    //handle to the cygpath process
     HANDLE              output,     //the target output handle
     LPCTSTR             path,       //the path to translate
     path_options_t      options     //translation options
@@ -66,129 +92,341 @@ error_t cygpath(                    //translates path strings
     path_options_t      options     //translation options
 ) {                                 //length of output or error
 
-    //local macros
-
-    //test for unicode interface
-    #ifdef UNICODE
-        #define free_buffer() free( buffer )
-    #else
-        #define free_buffer()
-    #endif
-
     //local variables
     char*               buffer;     //pipe reading buffer (bytes only)
+    unsigned long       capacity;   //size of the reading buffer
     #ifdef UNICODE
     int                 conv_result;//result of string conversion
     #endif
-    DWORD               length;     //length of child process' output string
+    DWORD               exit_code;  //exit code of the cygpath process
+    size_t              limit;      //most bytes of a path that can fit
+    pipe_stream_t       pipe;       //child stdout read-end of pipe
+    HANDLE              process;    //handle to the cygpath process
     error_t             result;     //resulting string length/error
-    HANDLE              read_pipe;  //child stdout read-end of pipe
     error_t             run_result; //result of creating cygpath process
-    SECURITY_ATTRIBUTES sec_attrs;  //pipe security attributes
-    BOOL                win_result; //result of Win32 calls
+    DWORD               start;      //tick count when cygpath was started
+    stream_t            stream;     //stream interface to the pipe
+    DWORD               wait_result;//result of waiting on cygpath
     HANDLE              write_pipe; //child stdout write-end of pipe
 
     //initialize a generic return value
     result = ERROR_UNKNOWN;
 
     //check input
-    if( ( tr_path == NULL ) || ( path == NULL ) ) {
+    if( ( tr_path == NULL ) || ( tr_size < 2 ) || ( path == NULL ) ) {
         return ERROR_USAGE;
     }
 
-    //initialize security attributes
-    memset( &sec_attrs, 0, sizeof( sec_attrs ) );
-    sec_attrs.nLength        = sizeof( SECURITY_ATTRIBUTES );
-    sec_attrs.bInheritHandle = TRUE;
+    //the read buffer holds the longest path that can fit, its line ending,
+    //  and a terminator (multi-byte output may need 2 bytes per character)
+    limit    = ( tr_size - 1 ) * sizeof( TCHAR );
+    capacity = ( unsigned long ) ( limit + 2 );
+    buffer   = calloc( ( capacity + 1 ), sizeof( char ) );
+
+    if( buffer == NULL ) {
+        return ERROR_ALLOC;
+    }
 
     //create a pipe for child process' stdout
-    win_result = CreatePipe( &read_pipe, &write_pipe, &sec_attrs, 0 );
+    memset( &pipe, 0, sizeof( pipe ) );
+    run_result = create_pipe( &pipe.handle, &write_pipe );
 
-    if( win_result == FALSE ) {
-        return ERROR_API_RESULT;
+    if( run_result != ERROR_NONE ) {
+        free( buffer );
+        return run_result;
     }
 
-    //read-end of pipe must not be inherited
-    win_result = SetHandleInformation(
-        read_pipe,
-        HANDLE_FLAG_INHERIT,
-        0
-    );
+    pipe.overlapped.hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
 
-    if( win_result == FALSE ) {
-        CloseHandle( read_pipe );
+    if( pipe.overlapped.hEvent == NULL ) {
+        free( buffer );
+        CloseHandle( pipe.handle );
         CloseHandle( write_pipe );
         return ERROR_API_RESULT;
     }
 
     //create the child process to run cygpath
-    run_result = run_cygpath( write_pipe, path, options );
+    start      = GetTickCount();
+    run_result = run_cygpath( &process, write_pipe, path, options );
+
+    //the child owns the write-end now; closing ours lets EOF arrive
+    CloseHandle( write_pipe );
 
     if( run_result != ERROR_NONE ) {
-        CloseHandle( read_pipe );
-        CloseHandle( write_pipe );
+        free( buffer );
+        CloseHandle( pipe.overlapped.hEvent );
+        CloseHandle( pipe.handle );
         return run_result;
     }
 
-    //initialize read buffer
-    #ifdef UNICODE
-        buffer = calloc( tr_size, sizeof( char ) );
-    #else
-        buffer = tr_path;
-    #endif
+    //stream output from child process' stdout pipe until it is closed
+    stream.context = &pipe;
+    stream.read    = pipe_read;
+    stream.clock   = pipe_clock;
+    result = stream_read(
+        buffer,
+        capacity,
+        &stream,
+        start,
+        CONFIG_CYGPATH_TIMEOUT
+    );
+
+    //wait for the child to exit with whatever time remains
+    if( result >= ERROR_NONE ) {
+        wait_result = WaitForSingleObject(
+            process,
+            stream_remaining( &stream, start, CONFIG_CYGPATH_TIMEOUT )
+        );
+        if( wait_result == WAIT_TIMEOUT ) {
+            result = ERROR_CHILD_TIMEOUT;
+        }
+        else if( wait_result != WAIT_OBJECT_0 ) {
+            result = ERROR_API_RESULT;
+        }
+        else if( GetExitCodeProcess( process, &exit_code ) == FALSE ) {
+            result = ERROR_API_RESULT;
+        }
+        else if( exit_code != 0 ) {
+            result = ERROR_CHILD_EXIT;
+        }
+    }
 
-    //read output from child process' stdout pipe
-    win_result = ReadFile( read_pipe, buffer, tr_size, &length, NULL );
+    CloseHandle( pipe.overlapped.hEvent );
+    CloseHandle( pipe.handle );
 
-    if( win_result == FALSE ) {
-        free_buffer();
-        CloseHandle( read_pipe );
-        CloseHandle( write_pipe );
-        return ERROR_API_RESULT;
+    //a child that failed to finish in time is not left behind
+    if( result < ERROR_NONE ) {
+        TerminateProcess( process, 1 );
+        free( buffer );
+        CloseHandle( process );
+        return result;
     }
 
-    //set the output string length (minus the trailing newline)
-    result = length - 1;
+    CloseHandle( process );
 
-    //trim the trailing newline
-    buffer[ result ] = 0;
+    //the output only has to fit once its line ending is removed
+    result = stream_trim( buffer, result );
 
     //see if unicode output conversion is necessary
     #ifdef UNICODE
 
         //convert the path to wide format
-        conv_result = MultiByteToWideChar(
-            CP_ACP,                     //use context's codepage
-            0,                          //default conversion settings
-            buffer,
-            result,
-            tr_path,
-            tr_size
-        );
+        if( result > 0 ) {
+            conv_result = MultiByteToWideChar(
+                CP_ACP,                 //use context's codepage
+                0,                      //default conversion settings
+                buffer,
+                result,
+                tr_path,
+                ( int ) ( tr_size - 1 )
+            );
+
+            //check result of string conversion
+            if( conv_result > 0 ) {
+                result = conv_result;
+            }
+            else if( GetLastError() == ERROR_INSUFFICIENT_BUFFER ) {
+                result = ERROR_OUTPUT_SIZE;
+            }
+            else {
+                result = ERROR_API_RESULT;
+            }
+        }
 
-        //check result of string conversion
-        if( conv_result != result ) {
+    //multi-byte output is copied as it is
+    #else
 
-            //indicate a failure to convert the string
-            result = ERROR_API_RESULT;
+        if( ( size_t ) result > limit ) {
+            result = ERROR_OUTPUT_SIZE;
+        }
+        else {
+            memcpy( tr_path, buffer, result );
         }
 
     #endif
 
-    //release allocated buffer
-    free_buffer();
+    //terminate the output string
+    if( result >= ERROR_NONE ) {
+        tr_path[ result ] = 0;
+    }
 
-    //release pipe handles
-    CloseHandle( read_pipe );
-    CloseHandle( write_pipe );
+    //release the read buffer
+    free( buffer );
 
     //return the result of translation
     return result;
 }
 
 
+/*=========================================================================*/
+static error_t create_pipe(         //creates an overlapped stdout pipe
+    HANDLE*             read_pipe,  //read-end of pipe (overlapped)
+    HANDLE*             write_pipe  //write-end of pipe (inheritable)
+) {                                 //error code (0 = no error)
+
+    //local macros
+    #define NAME_SIZE ( 64 )        //pipe name buffer size
+
+    //local variables
+    DWORD               error;      //last error from Win32 calls
+    TCHAR               name[ NAME_SIZE ];
+                                    //unique name for the pipe
+    OVERLAPPED          overlapped; //state of the pipe connection
+    static LONG         serial = 0; //distinguishes pipes in this process
+    SECURITY_ATTRIBUTES sec_attrs;  //pipe security attributes
+    HRESULT             str_result; //result of string calls
+    BOOL                win_result; //result of Win32 calls
+
+    //anonymous pipes can not be read with overlapped I/O, so create a
+    //  named pipe that is unique to this process
+    str_result = StringCchPrintf(
+        name,
+        NAME_SIZE,
+        _T( "\\\\.\\pipe\\cygassoc-cygpath-%lu-%ld" ),
+        GetCurrentProcessId(),
+        InterlockedIncrement( &serial )
+    );
+
+    if( str_result != S_OK ) {
+        return ERROR_API_RESULT;
+    }
+
+    //read-end of pipe is overlapped, and must not be inherited
+    *read_pipe = CreateNamedPipe(
+        name,
+        PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED
+            | FILE_FLAG_FIRST_PIPE_INSTANCE,
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT,
+        1,
+        0,
+        PIPE_BUFFER_SIZE,
+        0,
+        NULL
+    );
+
+    if( *read_pipe == INVALID_HANDLE_VALUE ) {
+        return ERROR_API_RESULT;
+    }
+
+    //initialize security attributes
+    memset( &sec_attrs, 0, sizeof( sec_attrs ) );
+    sec_attrs.nLength        = sizeof( SECURITY_ATTRIBUTES );
+    sec_attrs.bInheritHandle = TRUE;
+
+    //write-end of pipe is handed to the child as its stdout
+    *write_pipe = CreateFile(
+        name,
+        GENERIC_WRITE,
+        0,
+        &sec_attrs,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL
+    );
+
+    if( *write_pipe == INVALID_HANDLE_VALUE ) {
+        CloseHandle( *read_pipe );
+        return ERROR_API_RESULT;
+    }
+
+    //complete the server side of the connection
+    memset( &overlapped, 0, sizeof( overlapped ) );
+    win_result = ConnectNamedPipe( *read_pipe, &overlapped );
+    error      = GetLastError();
+
+    if( ( win_result == FALSE ) && ( error != ERROR_PIPE_CONNECTED ) ) {
+        CloseHandle( *read_pipe );
+        CloseHandle( *write_pipe );
+        return ERROR_API_RESULT;
+    }
+
+    //return success
+    return ERROR_NONE;
+}
+
+
+/*=========================================================================*/
+static unsigned long pipe_clock(    //reads the system tick count
+    void*               context     //pipe stream state (unused)
+) {                                 //current tick count
+
+    //return milliseconds since the system started
+    return GetTickCount();
+}
+
+
+/*=========================================================================*/
+static error_t pipe_read(           //reads what is available before a limit
+    void*               context,    //pipe stream state
+    char*               buffer,     //destination of output
+    unsigned long       size,       //size of destination
+    unsigned long       timeout,    //time limit (milliseconds)
+    unsigned long*      count       //bytes read (0 = end of stream)
+) {                                 //error code (0 = no error)
+
+    //local variables
+    DWORD               error;      //last error from Win32 calls
+    pipe_stream_t*      pipe;       //pipe stream state
+    DWORD               transferred;//bytes transferred by the read
+    DWORD               wait_result;//result of waiting on the read
+    BOOL                win_result; //result of Win32 calls
+
+    //start reading the next chunk of output
+    pipe       = context;
+    *count     = 0;
+    win_result = ReadFile(
+        pipe->handle,
+        buffer,
+        size,
+        NULL,
+        &pipe->overlapped
+    );
+
+    //wait for a pending read, but only until the time limit
+    if( win_result == FALSE ) {
+        error = GetLastError();
+        if( error == ERROR_BROKEN_PIPE ) {
+            return ERROR_NONE;
+        }
+        if( error != ERROR_IO_PENDING ) {
+            return ERROR_API_RESULT;
+        }
+        wait_result = WaitForSingleObject( pipe->overlapped.hEvent, timeout );
+        if( wait_result != WAIT_OBJECT_0 ) {
+            CancelIo( pipe->handle );
+            GetOverlappedResult(
+                pipe->handle,
+                &pipe->overlapped,
+                &transferred,
+                TRUE
+            );
+            return ( wait_result == WAIT_TIMEOUT )
+                ? ERROR_CHILD_TIMEOUT : ERROR_API_RESULT;
+        }
+    }
+
+    //collect the result of the read (a closed pipe is the end of output)
+    win_result = GetOverlappedResult(
+        pipe->handle,
+        &pipe->overlapped,
+        &transferred,
+        FALSE
+    );
+
+    if( win_result == FALSE ) {
+        return ( GetLastError() == ERROR_BROKEN_PIPE )
+            ? ERROR_NONE : ERROR_API_RESULT;
+    }
+
+    //return the number of bytes read
+    *count = transferred;
+    return ERROR_NONE;
+}
+
+
 /*=========================================================================*/
 static error_t run_cygpath(         //runs cygpath with a given output handle
+    HANDLE*             process,    //handle to the cygpath process
     HANDLE              output,     //the target output handle
     LPCTSTR             path,       //the path to translate
     path_options_t      options     //translation options
@@ -247,11 +485,10 @@ static error_t run_cygpath(         //runs cygpath with a given output handle
         return ERROR_API_RESULT;
     }
 
-    //close the process handles
-    CloseHandle( proc_info.hProcess );
+    //the caller waits on the process; the thread handle is not needed
     CloseHandle( proc_info.hThread );
+    *process = proc_info.hProcess;
 
     //return success
     return ERROR_NONE;
 }
-
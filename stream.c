@@ -0,0 +1,139 @@
+/*****************************************************************************
+
+stream.c
+
+Bounded reading of child process output.  The stream's read operation does
+the platform-specific I/O; this module only loops it until the end of the
+stream within a deadline, and checks that the output fits.
+
+*****************************************************************************/
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <stdlib.h>
+
+#include "error.h"
+#include "stream.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Module Variables
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Module Prototypes
+----------------------------------------------------------------------------*/
+
+
+/*==========================================================================*/
+error_t stream_read(                //reads a stream until its end
+    char*               buffer,     //destination of stream output
+    unsigned long       capacity,   //size of destination buffer
+    stream_t*           stream,     //stream to read
+    unsigned long       start,      //tick count when the deadline started
+    unsigned long       timeout     //deadline relative to start
+) {                                 //length of output or error
+
+    //local variables
+    unsigned long       count;      //bytes transferred by one read
+    char                extra;      //probe for output past the buffer
+    unsigned long       length;     //total bytes read from the stream
+    error_t             result;     //result of a read
+
+    //check input
+    if( ( buffer == NULL ) || ( stream == NULL ) ) {
+        return ERROR_USAGE;
+    }
+
+    //read until the child closes its end of the stream
+    length = 0;
+    for( ; ; ) {
+
+        //a full buffer is only acceptable if the stream ends there
+        if( length >= capacity ) {
+            result = stream->read(
+                stream->context,
+                &extra,
+                1,
+                stream_remaining( stream, start, timeout ),
+                &count
+            );
+            if( result != ERROR_NONE ) {
+                return result;
+            }
+            return ( count == 0 ) ? ( error_t ) length : ERROR_OUTPUT_SIZE;
+        }
+
+        //read the next chunk of output, but only until the deadline
+        result = stream->read(
+            stream->context,
+            ( buffer + length ),
+            ( capacity - length ),
+            stream_remaining( stream, start, timeout ),
+            &count
+        );
+
+        if( result != ERROR_NONE ) {
+            return result;
+        }
+
+        //the end of the stream
+        if( count == 0 ) {
+            return length;
+        }
+
+        length += count;
+    }
+}
+
+
+/*=========================================================================*/
+unsigned long stream_remaining(     //computes time left before a deadline
+    stream_t*           stream,     //stream providing the clock
+    unsigned long       start,      //tick count when the deadline started
+    unsigned long       timeout     //deadline relative to start
+) {                                 //milliseconds left (0 = expired)
+
+    //local variables
+    unsigned long       elapsed;    //time since the deadline started
+
+    //unsigned subtraction handles tick count roll-over
+    elapsed = stream->clock( stream->context ) - start;
+
+    //return the time left
+    return ( elapsed >= timeout ) ? 0 : ( timeout - elapsed );
+}
+
+
+/*=========================================================================*/
+error_t stream_trim(                //trims trailing line endings
+    char*               buffer,     //output to trim (terminated in place)
+    error_t             length      //length of the output
+) {                                 //trimmed length
+
+    //trim the trailing newline (and carriage return, if any)
+    while(
+        ( length > 0 )
+        &&
+        ( ( buffer[ length - 1 ] == '\n' ) || ( buffer[ length - 1 ] == '\r' ) )
+    ) {
+        length -= 1;
+    }
+    buffer[ length ] = 0;
+
+    //return the trimmed length
+    return length;
+}
@@ -0,0 +1,70 @@
+/*****************************************************************************
+
+stream.h
+
+Bounded reading of child process output interface declarations.
+
+*****************************************************************************/
+
+#ifndef _STREAM_H
+#define _STREAM_H
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <stdlib.h>
+
+#include "error.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+typedef struct stream_s {           //source of child process output
+    void*               context;    //implementation's state
+    error_t ( *read )(              //reads what is available before a limit
+        void*           context,    //implementation's state
+        char*           buffer,     //destination of output
+        unsigned long   size,       //size of destination
+        unsigned long   timeout,    //time limit (milliseconds)
+        unsigned long*  count       //bytes read (0 = end of stream)
+    );                              //error code (0 = no error)
+    unsigned long ( *clock )(       //reads a millisecond tick count
+        void*           context     //implementation's state
+    );                              //current tick count
+} stream_t;
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Interface Prototypes
+----------------------------------------------------------------------------*/
+
+error_t stream_read(                //reads a stream until its end
+    char*               buffer,     //destination of stream output
+    unsigned long       capacity,   //size of destination buffer
+    stream_t*           stream,     //stream to read
+    unsigned long       start,      //tick count when the deadline started
+    unsigned long       timeout     //deadline relative to start
+);                                  //length of output or error
+
+unsigned long stream_remaining(     //computes time left before a deadline
+    stream_t*           stream,     //stream providing the clock
+    unsigned long       start,      //tick count when the deadline started
+    unsigned long       timeout     //deadline relative to start
+);                                  //milliseconds left (0 = expired)
+
+error_t stream_trim(                //trims trailing line endings
+    char*               buffer,     //output to trim (terminated in place)
+    error_t             length      //length of the output
+);                                  //trimmed length
+
+
+#endif  /* _STREAM_H */
@@ -0,0 +1,306 @@
+/*****************************************************************************
+
+symlink.c
+
+Decoding of Cygwin symlink files.  A Cygwin symlink is a system file that
+starts with a marker ("!<symlink>"), followed by the target path.  Newer
+symlinks store the target in UTF-16LE (after a byte order mark), and older
+ones store it in UTF-8.  Targets are usually POSIX paths.
+
+This module only works on bytes and UTF-16 code units so it can be built and
+tested without Win32.
+
+*****************************************************************************/
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "symlink.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+#define is_separator( _c ) ( ( ( _c ) == '\\' ) || ( ( _c ) == '/' ) )
+                                    //tests for a directory separator
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Module Variables
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Module Prototypes
+----------------------------------------------------------------------------*/
+
+static error_t decode_utf8(         //decodes a UTF-8 target
+    symlink_char_t*     target,     //target output (UTF-16)
+    size_t              size,       //size of output (code units)
+    const unsigned char*
+                        content,    //encoded target
+    size_t              length      //length of encoded target
+);                                  //length of output or error
+
+static error_t decode_utf16(        //decodes a UTF-16LE target
+    symlink_char_t*     target,     //target output (UTF-16)
+    size_t              size,       //size of output (code units)
+    const unsigned char*
+                        content,    //encoded target
+    size_t              length      //length of encoded target
+);                                  //length of output or error
+
+
+/*==========================================================================*/
+int symlink_is_absolute(            //tests for a POSIX-absolute target
+    const symlink_char_t*
+                        target      //target of a symlink
+) {                                 //non-zero if the target is absolute
+
+    //POSIX paths only have meaning to Cygwin (e.g. cygpath)
+    return ( target != NULL ) && ( target[ 0 ] == '/' );
+}
+
+
+/*==========================================================================*/
+error_t symlink_join(               //joins a target to the link's directory
+    symlink_char_t*     output,     //joined path output
+    size_t              size,       //size of output (code units)
+    const symlink_char_t*
+                        link,       //Windows path to the symlink file
+    const symlink_char_t*
+                        target      //relative target of the symlink
+) {                                 //length of output or error
+
+    //local variables
+    size_t              index;      //index into a path
+    size_t              length;     //length of the output
+    size_t              prefix;     //length of the link's directory
+
+    //check input
+    if( ( output == NULL ) || ( link == NULL ) || ( target == NULL ) ) {
+        return ERROR_USAGE;
+    }
+
+    //Windows-absolute targets (drive or UNC) are not joined
+    if(
+        ( ( target[ 0 ] != 0 ) && ( target[ 1 ] == ':' ) )
+        ||
+        ( target[ 0 ] == '\\' )
+    ) {
+        prefix = 0;
+    }
+
+    //the directory includes its trailing separator
+    else {
+        prefix = 0;
+        for( index = 0; link[ index ] != 0; ++index ) {
+            if( is_separator( link[ index ] ) ) {
+                prefix = index + 1;
+            }
+        }
+    }
+
+    //copy the directory, then the target
+    for( length = 0; length < prefix; ++length ) {
+        if( ( length + 1 ) >= size ) {
+            return ERROR_OUTPUT_SIZE;
+        }
+        output[ length ] = link[ length ];
+    }
+    for( index = 0; target[ index ] != 0; ++index, ++length ) {
+        if( ( length + 1 ) >= size ) {
+            return ERROR_OUTPUT_SIZE;
+        }
+        output[ length ] = target[ index ];
+    }
+    output[ length ] = 0;
+
+    //return the length of the joined path
+    return length;
+}
+
+
+/*==========================================================================*/
+error_t symlink_parse(              //decodes the target of a symlink file
+    symlink_char_t*     target,     //target output (UTF-16)
+    size_t              size,       //size of output (code units)
+    const unsigned char*
+                        content,    //contents of the file
+    size_t              length      //length of the contents
+) {                                 //length of output or error (0 = none)
+
+    //local variables
+    error_t             result;     //resulting string length/error
+
+    //check input
+    if( ( target == NULL ) || ( size < 1 ) || ( content == NULL ) ) {
+        return ERROR_USAGE;
+    }
+
+    //files without the symlink marker are ordinary files
+    if(
+        ( length < SYMLINK_COOKIE_SIZE )
+        ||
+        ( memcmp( content, SYMLINK_COOKIE, SYMLINK_COOKIE_SIZE ) != 0 )
+    ) {
+        return 0;
+    }
+    content += SYMLINK_COOKIE_SIZE;
+    length  -= SYMLINK_COOKIE_SIZE;
+
+    //newer symlinks are UTF-16LE following a byte order mark
+    if(
+        ( length >= 2 ) && ( content[ 0 ] == 0xFF ) && ( content[ 1 ] == 0xFE )
+    ) {
+        result = decode_utf16(
+            target,
+            size,
+            ( content + 2 ),
+            ( length - 2 )
+        );
+    }
+
+    //older symlinks are UTF-8
+    else {
+        result = decode_utf8( target, size, content, length );
+    }
+
+    //a symlink must have a target
+    if( result == 0 ) {
+        return ERROR_LINK_FORMAT;
+    }
+
+    //return the length of the target
+    return result;
+}
+
+
+/*=========================================================================*/
+static error_t decode_utf8(         //decodes a UTF-8 target
+    symlink_char_t*     target,     //target output (UTF-16)
+    size_t              size,       //size of output (code units)
+    const unsigned char*
+                        content,    //encoded target
+    size_t              length      //length of encoded target
+) {                                 //length of output or error
+
+    //local variables
+    unsigned long       code;       //decoded code point
+    size_t              extra;      //continuation bytes in a sequence
+    size_t              index;      //index into the encoded target
+    size_t              output;     //length of the output
+    size_t              units;      //code units needed for a code point
+
+    //decode until a terminator or the end of the content
+    output = 0;
+    for( index = 0; ( index < length ) && ( content[ index ] != 0 ); ) {
+
+        //the lead byte gives the length of the sequence
+        code = content[ index ];
+        if( code < 0x80 ) {
+            extra = 0;
+        }
+        else if( ( code & 0xE0 ) == 0xC0 ) {
+            extra = 1;
+            code &= 0x1F;
+        }
+        else if( ( code & 0xF0 ) == 0xE0 ) {
+            extra = 2;
+            code &= 0x0F;
+        }
+        else if( ( code & 0xF8 ) == 0xF0 ) {
+            extra = 3;
+            code &= 0x07;
+        }
+        else {
+            return ERROR_LINK_FORMAT;
+        }
+        index += 1;
+
+        //accumulate the continuation bytes
+        if( ( index + extra ) > length ) {
+            return ERROR_LINK_FORMAT;
+        }
+        for( ; extra > 0; --extra, ++index ) {
+            if( ( content[ index ] & 0xC0 ) != 0x80 ) {
+                return ERROR_LINK_FORMAT;
+            }
+            code = ( code << 6 ) | ( content[ index ] & 0x3F );
+        }
+
+        //surrogates and out-of-range values are not code points
+        if(
+            ( ( code >= 0xD800 ) && ( code <= 0xDFFF ) )
+            ||
+            ( code > 0x10FFFF )
+        ) {
+            return ERROR_LINK_FORMAT;
+        }
+
+        //store the code point (as a surrogate pair if necessary)
+        units = ( code >= 0x10000 ) ? 2 : 1;
+        if( ( output + units ) >= size ) {
+            return ERROR_OUTPUT_SIZE;
+        }
+        if( units == 2 ) {
+            code -= 0x10000;
+            target[ output++ ] = ( symlink_char_t )
+                ( 0xD800 | ( code >> 10 ) );
+            target[ output++ ] = ( symlink_char_t )
+                ( 0xDC00 | ( code & 0x3FF ) );
+        }
+        else {
+            target[ output++ ] = ( symlink_char_t ) code;
+        }
+    }
+    target[ output ] = 0;
+
+    //return the length of the output
+    return output;
+}
+
+
+/*=========================================================================*/
+static error_t decode_utf16(        //decodes a UTF-16LE target
+    symlink_char_t*     target,     //target output (UTF-16)
+    size_t              size,       //size of output (code units)
+    const unsigned char*
+                        content,    //encoded target
+    size_t              length      //length of encoded target
+) {                                 //length of output or error
+
+    //local variables
+    size_t              index;      //index into the encoded target
+    size_t              output;     //length of the output
+    symlink_char_t      unit;       //decoded code unit
+
+    //decode whole code units until a terminator or the end of the content
+    output = 0;
+    for( index = 0; ( index + 1 ) < length; index += 2 ) {
+        unit = ( symlink_char_t )
+            ( content[ index ] | ( content[ index + 1 ] << 8 ) );
+        if( unit == 0 ) {
+            break;
+        }
+        if( ( output + 1 ) >= size ) {
+            return ERROR_OUTPUT_SIZE;
+        }
+        target[ output++ ] = unit;
+    }
+    target[ output ] = 0;
+
+    //return the length of the output
+    return output;
+}
@@ -0,0 +1,67 @@
+/*****************************************************************************
+
+symlink.h
+
+Cygwin symlink file decoding interface declarations.
+
+*****************************************************************************/
+
+#ifndef _SYMLINK_H
+#define _SYMLINK_H
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <stdlib.h>
+
+#include "error.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+#define SYMLINK_COOKIE "!<symlink>" //start of a Cygwin symlink file
+
+#define SYMLINK_COOKIE_SIZE ( sizeof( SYMLINK_COOKIE ) - 1 )
+                                    //length of Cygwin symlink marker
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+typedef unsigned short symlink_char_t;
+                                    //UTF-16 code unit (the size of WCHAR)
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Interface Prototypes
+----------------------------------------------------------------------------*/
+
+int symlink_is_absolute(            //tests for a POSIX-absolute target
+    const symlink_char_t*
+                        target      //target of a symlink
+);                                  //non-zero if the target is absolute
+
+error_t symlink_join(               //joins a target to the link's directory
+    symlink_char_t*     output,     //joined path output
+    size_t              size,       //size of output (code units)
+    const symlink_char_t*
+                        link,       //Windows path to the symlink file
+    const symlink_char_t*
+                        target      //relative target of the symlink
+);                                  //length of output or error
+
+error_t symlink_parse(              //decodes the target of a symlink file
+    symlink_char_t*     target,     //target output (UTF-16)
+    size_t              size,       //size of output (code units)
+    const unsigned char*
+                        content,    //contents of the file
+    size_t              length      //length of the contents
+);                                  //length of output or error (0 = none)
+
+
+#endif  /* _SYMLINK_H */
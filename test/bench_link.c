@@ -0,0 +1,236 @@
+/*****************************************************************************
+
+bench_link.c
+
+Times the platform-independent parts of link resolution with the host's
+compiler: decoding symlink files, joining relative targets, and finding a
+link in the cache (a hit) against parsing and storing it (a miss).
+
+    make -C test bench
+
+File system access (reading the link, and its attributes) is not included,
+so the numbers compare the cost of the work a cache hit avoids, not the
+whole of a launch.
+
+*****************************************************************************/
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "error.h"
+#include "linkcache.h"
+#include "symlink.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+#define ROUNDS ( 1000000 )          //operations timed per measurement
+
+#define PATH_SIZE ( 512 )           //size of path buffers (same as link.c)
+
+#define MTIME ( 0x01D5A0B1C2D3E4F5ULL )
+                                    //modification time of the link
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+static const unsigned char utf8_link[] =
+    "!<symlink>../src/project/main.c\0";
+                                    //older symlink, relative target
+
+static const unsigned char utf16_link[] =
+    "!<symlink>\xFF\xFE"
+    "/\0h\0o\0m\0e\0/\0u\0s\0e\0r\0/\0s\0r\0c\0/\0m\0a\0i\0n\0.\0c\0\0\0";
+                                    //newer symlink, absolute target
+
+/*----------------------------------------------------------------------------
+Module Variables
+----------------------------------------------------------------------------*/
+
+static link_cache_t     cache;      //cache being timed
+
+static volatile long    sink;       //keeps results from being optimized out
+
+/*----------------------------------------------------------------------------
+Module Prototypes
+----------------------------------------------------------------------------*/
+
+static double now_ns(               //reads a monotonic clock
+    void
+);                                  //current time (nanoseconds)
+
+static void report(                 //prints the cost of one operation
+    const char*         name,       //name of the operation
+    double              start       //time the rounds started (ns)
+);
+
+static void widen(                  //converts an ASCII string to UTF-16
+    symlink_char_t*     units,      //UTF-16 output (PATH_SIZE)
+    const char*         text        //ASCII string
+);
+
+
+/*==========================================================================*/
+int main(                           //runs the link benchmarks
+    void
+) {                                 //exit status
+
+    //local variables
+    const link_entry_t* entry;      //entry found in the cache
+    char                filler[ 32 ];
+                                    //path of another cached link
+    symlink_char_t      joined[ PATH_SIZE ];
+                                    //joined path
+    symlink_char_t      link[ PATH_SIZE ];
+                                    //path to the link
+    long                round;      //index of a timed operation
+    double              start;      //time the rounds started (ns)
+    symlink_char_t      target[ PATH_SIZE ];
+                                    //decoded target
+    char                text[ PATH_SIZE ];
+                                    //decoded target (cache characters)
+    int                 index;      //character index
+
+    printf( "%d operations per measurement\n", ROUNDS );
+
+    //decoding symlink files
+    start = now_ns();
+    for( round = 0; round < ROUNDS; ++round ) {
+        sink += symlink_parse(
+            target, PATH_SIZE, utf8_link, ( sizeof( utf8_link ) - 1 )
+        );
+    }
+    report( "parse (UTF-8)", start );
+
+    start = now_ns();
+    for( round = 0; round < ROUNDS; ++round ) {
+        sink += symlink_parse(
+            target, PATH_SIZE, utf16_link, ( sizeof( utf16_link ) - 1 )
+        );
+    }
+    report( "parse (UTF-16)", start );
+
+    //joining a relative target to the link's directory
+    widen( link, "C:\\Users\\user\\Documents\\project\\link" );
+    symlink_parse( target, PATH_SIZE, utf8_link, ( sizeof( utf8_link ) - 1 ) );
+    start = now_ns();
+    for( round = 0; round < ROUNDS; ++round ) {
+        sink += symlink_join( joined, PATH_SIZE, link, target );
+    }
+    report( "join", start );
+
+    //a full cache, with the link stored last
+    link_cache_reset( &cache );
+    for( index = 0; index < ( LINK_CACHE_SIZE - 1 ); ++index ) {
+        sprintf( filler, "C:\\Users\\user\\link%d.lnk", index );
+        link_cache_store( &cache, filler, MTIME, "C:\\t", 0 );
+    }
+    link_cache_store(
+        &cache, "C:\\Users\\user\\Documents\\project\\link", MTIME,
+        "C:\\Users\\user\\Documents\\project\\../src/project/main.c", 0
+    );
+
+    //a hit: find the link and copy its target
+    start = now_ns();
+    for( round = 0; round < ROUNDS; ++round ) {
+        entry = link_cache_find(
+            &cache, "c:\\users\\user\\documents\\project\\link", MTIME
+        );
+        if( entry != NULL ) {
+            strcpy( text, entry->target );
+            sink += text[ 0 ];
+        }
+    }
+    report( "cache hit", start );
+
+    //a miss: search, then decode, join, and store the link
+    start = now_ns();
+    for( round = 0; round < ROUNDS; ++round ) {
+        entry = link_cache_find(
+            &cache, "C:\\Users\\user\\Documents\\project\\link", ( MTIME + 1 )
+        );
+        if( entry == NULL ) {
+            symlink_parse(
+                target, PATH_SIZE, utf8_link, ( sizeof( utf8_link ) - 1 )
+            );
+            sink += symlink_join( joined, PATH_SIZE, link, target );
+            for( index = 0; joined[ index ] != 0; ++index ) {
+                text[ index ] = ( char ) joined[ index ];
+            }
+            text[ index ] = 0;
+            sink += link_cache_store(
+                &cache, "C:\\Users\\user\\Documents\\project\\link", MTIME,
+                text, 0
+            );
+        }
+    }
+    report( "cache miss", start );
+
+    //return success
+    return 0;
+}
+
+
+/*=========================================================================*/
+static double now_ns(               //reads a monotonic clock
+    void
+) {                                 //current time (nanoseconds)
+
+    //local variables
+    struct timespec     now;        //current time
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( now.tv_sec * 1e9 ) + now.tv_nsec;
+}
+
+
+/*=========================================================================*/
+static void report(                 //prints the cost of one operation
+    const char*         name,       //name of the operation
+    double              start       //time the rounds started (ns)
+) {
+
+    //local variables
+    double              elapsed;    //time taken by all rounds (ns)
+
+    elapsed = now_ns() - start;
+    printf(
+        "%-16s %8.1f ns/op  %12.0f ops/s\n",
+        name,
+        ( elapsed / ROUNDS ),
+        ( ( elapsed > 0.0 ) ? ( ROUNDS * 1e9 / elapsed ) : 0.0 )
+    );
+}
+
+
+/*=========================================================================*/
+static void widen(                  //converts an ASCII string to UTF-16
+    symlink_char_t*     units,      //UTF-16 output (PATH_SIZE)
+    const char*         text        //ASCII string
+) {
+
+    //local variables
+    size_t              index;      //index into the strings
+
+    //copy each character, including the terminator
+    for(
+        index = 0;
+        ( ( index + 1 ) < PATH_SIZE ) && ( text[ index ] != 0 );
+        ++index
+    ) {
+        units[ index ] = ( symlink_char_t ) text[ index ];
+    }
+    units[ index ] = 0;
+}
@@ -0,0 +1,59 @@
+/*****************************************************************************
+
+test.h
+
+Minimal checking macros shared by the host-built tests.
+
+*****************************************************************************/
+
+#ifndef _TEST_H
+#define _TEST_H
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+#define check( _c ) test_check( ( _c ), #_c, __FILE__, __LINE__ )
+                                    //checks a condition, reporting failures
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Module Variables
+----------------------------------------------------------------------------*/
+
+static int              test_failures = 0;
+                                    //number of failed checks
+
+/*----------------------------------------------------------------------------
+Interface Prototypes
+----------------------------------------------------------------------------*/
+
+static void test_check(             //records the result of one check
+    int                 condition,  //result of the check
+    const char*         text,       //source text of the check
+    const char*         file,       //source file of the check
+    int                 line        //source line of the check
+) {
+
+    //report failed checks
+    if( condition == 0 ) {
+        printf( "%s:%d: check failed: %s\n", file, line, text );
+        test_failures += 1;
+    }
+}
+
+
+#endif  /* _TEST_H */
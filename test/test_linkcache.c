@@ -0,0 +1,112 @@
+/*****************************************************************************
+
+test_linkcache.c
+
+Tests finding, storing, and replacing resolved links in the link cache.
+
+*****************************************************************************/
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "linkcache.h"
+#include "test.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+#define MTIME ( 0x01D5A0B1C2D3E4F5ULL )
+                                    //modification time of a link
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Module Variables
+----------------------------------------------------------------------------*/
+
+static link_cache_t     cache;      //cache under test
+
+/*----------------------------------------------------------------------------
+Module Prototypes
+----------------------------------------------------------------------------*/
+
+
+/*==========================================================================*/
+int main(                           //runs the link cache tests
+    void
+) {                                 //number of failed checks
+
+    //local variables
+    const link_entry_t* entry;      //entry found in the cache
+    int                 index;      //index of a stored link
+    char                link[ 32 ]; //path to a link
+    char                long_path[ LINK_CACHE_PATH_SIZE + 8 ];
+                                    //path that does not fit in the cache
+
+    //an empty cache finds nothing, and is valid
+    link_cache_reset( &cache );
+    check( link_cache_valid( &cache ) );
+    check( link_cache_find( &cache, "C:\\a.lnk", MTIME ) == NULL );
+    check( link_cache_find( &cache, "", 0 ) == NULL );
+
+    //a stored link is found by its path (in any case) and time
+    check( link_cache_store( &cache, "C:\\a.lnk", MTIME, "C:\\b.c", 0 ) );
+    entry = link_cache_find( &cache, "c:\\A.LNK", MTIME );
+    check( entry != NULL );
+    check( ( entry != NULL ) && ( strcmp( entry->target, "C:\\b.c" ) == 0 ) );
+    check( ( entry != NULL ) && ( entry->final == 0 ) );
+
+    //a link that changed since it was stored is not found
+    check( link_cache_find( &cache, "C:\\a.lnk", ( MTIME + 1 ) ) == NULL );
+
+    //storing a changed link replaces its entry
+    check( link_cache_store( &cache, "C:\\A.lnk", ( MTIME + 1 ), "/x", 1 ) );
+    entry = link_cache_find( &cache, "C:\\a.lnk", ( MTIME + 1 ) );
+    check( ( entry != NULL ) && ( strcmp( entry->target, "/x" ) == 0 ) );
+    check( ( entry != NULL ) && ( entry->final == 1 ) );
+    check( cache.next == 1 );
+
+    //files that are not links are remembered with an empty target
+    check( link_cache_store( &cache, "C:\\sys.txt", MTIME, "", 0 ) );
+    entry = link_cache_find( &cache, "C:\\sys.txt", MTIME );
+    check( ( entry != NULL ) && ( entry->target[ 0 ] == 0 ) );
+
+    //the oldest link is replaced once the cache is full
+    for( index = 0; index < LINK_CACHE_SIZE; ++index ) {
+        sprintf( link, "C:\\link%d.lnk", index );
+        check( link_cache_store( &cache, link, MTIME, "C:\\t", 0 ) );
+    }
+    check( link_cache_find( &cache, "C:\\a.lnk", ( MTIME + 1 ) ) == NULL );
+    check( link_cache_find( &cache, "C:\\sys.txt", MTIME ) == NULL );
+    check( link_cache_find( &cache, "C:\\link0.lnk", MTIME ) != NULL );
+    check( link_cache_valid( &cache ) );
+
+    //paths that do not fit are not remembered
+    memset( long_path, 'x', sizeof( long_path ) );
+    long_path[ sizeof( long_path ) - 1 ] = 0;
+    check( link_cache_store( &cache, long_path, MTIME, "C:\\t", 0 ) == 0 );
+    check( link_cache_store( &cache, "C:\\l.lnk", MTIME, long_path, 0 ) == 0 );
+    check( link_cache_find( &cache, "C:\\l.lnk", MTIME ) == NULL );
+
+    //caches from other builds, or that are damaged, are not valid
+    cache.magic = 0;
+    check( !link_cache_valid( &cache ) );
+    link_cache_reset( &cache );
+    cache.next = LINK_CACHE_SIZE;
+    check( !link_cache_valid( &cache ) );
+
+    //report the results
+    printf( "test_linkcache: %d failed check(s)\n", test_failures );
+    return test_failures;
+}
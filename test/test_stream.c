@@ -0,0 +1,294 @@
+/*****************************************************************************
+
+test_stream.c
+
+Tests bounded reading of child process output against stand-in children that
+write all at once, write in pieces, stall, or write too much.
+
+*****************************************************************************/
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "stream.h"
+#include "test.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+#define TIMEOUT ( 300 )             //deadline given to each read (ms)
+
+#define BUFFER_SIZE ( 1024 )        //size of output buffers
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+typedef void ( *child_t )(          //behavior of a stand-in child
+    int                 output      //child's end of the pipe
+);
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Module Variables
+----------------------------------------------------------------------------*/
+
+static char             long_path[ 511 ];
+                                    //510 characters, then a newline
+
+/*----------------------------------------------------------------------------
+Module Prototypes
+----------------------------------------------------------------------------*/
+
+static unsigned long fd_clock(      //reads a monotonic millisecond clock
+    void*               context     //stream state (unused)
+);                                  //current tick count
+
+static error_t fd_read(             //reads what is available before a limit
+    void*               context,    //pointer to the file descriptor
+    char*               buffer,     //destination of output
+    unsigned long       size,       //size of destination
+    unsigned long       timeout,    //time limit (milliseconds)
+    unsigned long*      count       //bytes read (0 = end of stream)
+);                                  //error code (0 = no error)
+
+static error_t run_child(           //reads the output of a stand-in child
+    child_t             child,      //behavior of the child
+    char*               buffer,     //destination of output
+    unsigned long       capacity,   //size of destination
+    unsigned long*      elapsed     //time taken to read (ms)
+);                                  //length of output or error
+
+
+/*==========================================================================*/
+/* Stand-in children                                                        */
+/*==========================================================================*/
+static void pause_ms( long ms ) {
+    struct timespec delay;
+    delay.tv_sec  = ms / 1000;
+    delay.tv_nsec = ( ms % 1000 ) * 1000000L;
+    nanosleep( &delay, NULL );
+}
+
+static void write_text( int output, const char* text ) {
+    write( output, text, strlen( text ) );
+}
+
+static void child_whole( int output ) {
+    write_text( output, "/cygdrive/c/src/main.c\n" );
+}
+
+static void child_pieces( int output ) {
+    write_text( output, "/home" );
+    pause_ms( 50 );
+    write_text( output, "/user" );
+    pause_ms( 50 );
+    write_text( output, "/file.c\r\n" );
+}
+
+static void child_empty( int output ) {
+}
+
+static void child_stall( int output ) {
+    pause_ms( 5000 );
+}
+
+static void child_partial_stall( int output ) {
+    write_text( output, "/tmp/par" );
+    pause_ms( 5000 );
+}
+
+static void child_overflow( int output ) {
+    int index;
+    for( index = 0; index < 64; ++index ) {
+        write_text( output, "/overflow" );
+    }
+    write_text( output, "\n" );
+}
+
+static void child_exact( int output ) {
+    write_text( output, "0123456789ab" );
+}
+
+static void child_long( int output ) {
+    write( output, long_path, sizeof( long_path ) );
+}
+
+
+/*==========================================================================*/
+int main(                           //runs the stream tests
+    void
+) {                                 //number of failed checks
+
+    //local variables
+    char                buffer[ BUFFER_SIZE ];
+                                    //output of a child
+    unsigned long       elapsed;    //time taken by a read
+    error_t             result;     //result of a read
+
+    //a child that writes everything at once
+    result = run_child( child_whole, buffer, 64, &elapsed );
+    check( result == 23 );
+    check( stream_trim( buffer, result ) == 22 );
+    check( strcmp( buffer, "/cygdrive/c/src/main.c" ) == 0 );
+
+    //a child that writes in pieces (with a CR-LF line ending)
+    result = run_child( child_pieces, buffer, 64, &elapsed );
+    check( result == 19 );
+    check( stream_trim( buffer, result ) == 17 );
+    check( strcmp( buffer, "/home/user/file.c" ) == 0 );
+
+    //a child that writes nothing
+    result = run_child( child_empty, buffer, 64, &elapsed );
+    check( result == 0 );
+    check( stream_trim( buffer, result ) == 0 );
+
+    //a child that never writes or exits fails at the deadline
+    result = run_child( child_stall, buffer, 64, &elapsed );
+    check( result == ERROR_CHILD_TIMEOUT );
+    check( elapsed >= ( TIMEOUT - 10 ) );
+    check( elapsed < ( TIMEOUT * 3 ) );
+
+    //a child that writes part of its output, then stalls
+    result = run_child( child_partial_stall, buffer, 64, &elapsed );
+    check( result == ERROR_CHILD_TIMEOUT );
+    check( elapsed < ( TIMEOUT * 3 ) );
+
+    //a child that writes more than fits
+    result = run_child( child_overflow, buffer, 64, &elapsed );
+    check( result == ERROR_OUTPUT_SIZE );
+
+    //output that exactly fills the buffer, then ends, fits
+    result = run_child( child_exact, buffer, 12, &elapsed );
+    check( result == 12 );
+
+    //output that fits once its line ending is trimmed (510 + "\n" in a
+    //  buffer for 511 characters plus a line ending)
+    memset( long_path, 'x', sizeof( long_path ) );
+    long_path[ 0 ] = '/';
+    long_path[ sizeof( long_path ) - 1 ] = '\n';
+    result = run_child( child_long, buffer, ( 511 + 2 ), &elapsed );
+    check( result == 511 );
+    check( stream_trim( buffer, result ) == 510 );
+
+    //report the results
+    printf( "test_stream: %d failed check(s)\n", test_failures );
+    return test_failures;
+}
+
+
+/*=========================================================================*/
+static unsigned long fd_clock(      //reads a monotonic millisecond clock
+    void*               context     //stream state (unused)
+) {                                 //current tick count
+
+    //local variables
+    struct timespec     now;        //current time
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( now.tv_sec * 1000UL ) + ( now.tv_nsec / 1000000UL );
+}
+
+
+/*=========================================================================*/
+static error_t fd_read(             //reads what is available before a limit
+    void*               context,    //pointer to the file descriptor
+    char*               buffer,     //destination of output
+    unsigned long       size,       //size of destination
+    unsigned long       timeout,    //time limit (milliseconds)
+    unsigned long*      count       //bytes read (0 = end of stream)
+) {                                 //error code (0 = no error)
+
+    //local variables
+    ssize_t             length;     //result of the read
+    struct pollfd       poll_fd;    //descriptor to wait on
+    int                 poll_result;//result of waiting
+
+    //wait for output, but only until the time limit
+    poll_fd.fd      = *( int* ) context;
+    poll_fd.events  = POLLIN;
+    poll_fd.revents = 0;
+    poll_result     = poll( &poll_fd, 1, ( int ) timeout );
+
+    if( poll_result == 0 ) {
+        return ERROR_CHILD_TIMEOUT;
+    }
+    if( poll_result < 0 ) {
+        return ERROR_API_RESULT;
+    }
+
+    //read what is available (0 = the child closed its end)
+    length = read( poll_fd.fd, buffer, size );
+
+    if( length < 0 ) {
+        return ERROR_API_RESULT;
+    }
+
+    *count = ( unsigned long ) length;
+    return ERROR_NONE;
+}
+
+
+/*=========================================================================*/
+static error_t run_child(           //reads the output of a stand-in child
+    child_t             child,      //behavior of the child
+    char*               buffer,     //destination of output
+    unsigned long       capacity,   //size of destination
+    unsigned long*      elapsed     //time taken to read (ms)
+) {                                 //length of output or error
+
+    //local variables
+    int                 fds[ 2 ];   //pipe between the test and the child
+    pid_t               pid;        //process ID of the child
+    error_t             result;     //result of the read
+    unsigned long       start;      //tick count when reading started
+    stream_t            stream;     //stream interface to the pipe
+
+    //start the child with the write-end of a pipe
+    if( pipe( fds ) != 0 ) {
+        return ERROR_API_RESULT;
+    }
+
+    pid = fork();
+    if( pid < 0 ) {
+        close( fds[ 0 ] );
+        close( fds[ 1 ] );
+        return ERROR_API_RESULT;
+    }
+    if( pid == 0 ) {
+        close( fds[ 0 ] );
+        child( fds[ 1 ] );
+        _exit( 0 );
+    }
+    close( fds[ 1 ] );
+
+    //read the child's output within the deadline
+    memset( buffer, 0, capacity + 1 );
+    stream.context = &fds[ 0 ];
+    stream.read    = fd_read;
+    stream.clock   = fd_clock;
+    start          = fd_clock( NULL );
+    result         = stream_read( buffer, capacity, &stream, start, TIMEOUT );
+    *elapsed       = fd_clock( NULL ) - start;
+
+    //the child is not left behind
+    close( fds[ 0 ] );
+    kill( pid, SIGKILL );
+    waitpid( pid, NULL, 0 );
+
+    //return the result of reading
+    return result;
+}
@@ -0,0 +1,253 @@
+/*****************************************************************************
+
+test_symlink.c
+
+Tests decoding of Cygwin symlink files from byte-level fixtures, and joining
+relative targets to the symlink's directory.
+
+*****************************************************************************/
+
+/*----------------------------------------------------------------------------
+Includes
+----------------------------------------------------------------------------*/
+
+#include <string.h>
+
+#include "error.h"
+#include "symlink.h"
+#include "test.h"
+
+/*----------------------------------------------------------------------------
+Macros
+----------------------------------------------------------------------------*/
+
+#define PATH_SIZE ( 64 )            //size of path buffers
+
+#define parse( _f ) \
+    symlink_parse( target, PATH_SIZE, ( _f ), ( sizeof( _f ) - 1 ) )
+                                    //parses a fixture (minus the literal's
+                                    //  own terminator)
+
+/*----------------------------------------------------------------------------
+Types and Structures
+----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+Memory Constants
+----------------------------------------------------------------------------*/
+
+static const unsigned char utf16_absolute[] =
+    "!<symlink>\xFF\xFE"
+    "/\0h\0o\0m\0e\0/\0u\0/\0x\0\0\0";
+                                    //newer symlink, absolute target
+
+static const unsigned char utf16_unterminated[] =
+    "!<symlink>\xFF\xFE"
+    "a\0/\0b\0c";
+                                    //UTF-16 target without a terminator
+                                    //  (and a stray odd byte)
+
+static const unsigned char utf16_empty[] =
+    "!<symlink>\xFF\xFE\0\0";       //UTF-16 symlink without a target
+
+static const unsigned char utf8_relative[] =
+    "!<symlink>../src/main.c\0";    //older symlink, relative target
+
+static const unsigned char utf8_accented[] =
+    "!<symlink>caf\xC3\xA9\0";      //two-byte UTF-8 sequence
+
+static const unsigned char utf8_astral[] =
+    "!<symlink>\xF0\x9F\x98\x80\0"; //four-byte UTF-8 sequence
+
+static const unsigned char utf8_truncated[] =
+    "!<symlink>ab\xC3";             //sequence cut off by the end of file
+
+static const unsigned char utf8_bad_continuation[] =
+    "!<symlink>\xE2\x28\xA1\0";     //invalid continuation byte
+
+static const unsigned char utf8_empty[] =
+    "!<symlink>\0";                 //UTF-8 symlink without a target
+
+static const unsigned char plain_file[] =
+    "int main( void ) { return 0; }\n";
+                                    //ordinary system file
+
+static const unsigned char short_file[] =
+    "!<sym";                        //file shorter than the marker
+
+/*----------------------------------------------------------------------------
+Module Variables
+----------------------------------------------------------------------------*/
+
+static symlink_char_t   target[ PATH_SIZE ];
+                                    //decoded target
+
+/*----------------------------------------------------------------------------
+Module Prototypes
+----------------------------------------------------------------------------*/
+
+static int equals(                  //compares UTF-16 to an ASCII string
+    const symlink_char_t*
+                        units,      //UTF-16 string
+    const char*         text        //ASCII string
+);                                  //non-zero if the strings are equal
+
+static const symlink_char_t* widen( //converts an ASCII string to UTF-16
+    symlink_char_t*     units,      //UTF-16 output (PATH_SIZE)
+    const char*         text        //ASCII string
+);                                  //the UTF-16 output
+
+
+/*==========================================================================*/
+int main(                           //runs the symlink tests
+    void
+) {                                 //number of failed checks
+
+    //local variables
+    symlink_char_t      joined[ PATH_SIZE ];
+                                    //joined path
+    symlink_char_t      link[ PATH_SIZE ];
+                                    //path to a link
+    symlink_char_t      relative[ PATH_SIZE ];
+                                    //relative target
+    error_t             result;     //result of a call
+
+    //newer (UTF-16) symlinks
+    result = parse( utf16_absolute );
+    check( result == 9 );
+    check( equals( target, "/home/u/x" ) );
+    check( symlink_is_absolute( target ) );
+
+    result = parse( utf16_unterminated );
+    check( result == 3 );
+    check( equals( target, "a/b" ) );
+    check( !symlink_is_absolute( target ) );
+
+    check( parse( utf16_empty ) == ERROR_LINK_FORMAT );
+
+    //older (UTF-8) symlinks
+    result = parse( utf8_relative );
+    check( result == 13 );
+    check( equals( target, "../src/main.c" ) );
+    check( !symlink_is_absolute( target ) );
+
+    result = parse( utf8_accented );
+    check( result == 4 );
+    check( ( target[ 3 ] == 0x00E9 ) && ( target[ 4 ] == 0 ) );
+
+    result = parse( utf8_astral );
+    check( result == 2 );
+    check( ( target[ 0 ] == 0xD83D ) && ( target[ 1 ] == 0xDE00 ) );
+
+    check( parse( utf8_truncated ) == ERROR_LINK_FORMAT );
+    check( parse( utf8_bad_continuation ) == ERROR_LINK_FORMAT );
+    check( parse( utf8_empty ) == ERROR_LINK_FORMAT );
+
+    //files that are not symlinks
+    check( parse( plain_file ) == 0 );
+    check( parse( short_file ) == 0 );
+
+    //targets that do not fit
+    result = symlink_parse(
+        target,
+        5,
+        utf8_relative,
+        ( sizeof( utf8_relative ) - 1 )
+    );
+    check( result == ERROR_OUTPUT_SIZE );
+
+    //relative targets join the link's directory
+    result = symlink_join(
+        joined,
+        PATH_SIZE,
+        widen( link, "C:\\work\\proj\\link" ),
+        widen( relative, "../src/main.c" )
+    );
+    check( result == 26 );
+    check( equals( joined, "C:\\work\\proj\\../src/main.c" ) );
+
+    result = symlink_join(
+        joined,
+        PATH_SIZE,
+        widen( link, "C:/work/link" ),
+        widen( relative, "main.c" )
+    );
+    check( equals( joined, "C:/work/main.c" ) );
+
+    result = symlink_join(
+        joined,
+        PATH_SIZE,
+        widen( link, "link" ),
+        widen( relative, "main.c" )
+    );
+    check( equals( joined, "main.c" ) );
+
+    //Windows-absolute targets are not joined
+    result = symlink_join(
+        joined,
+        PATH_SIZE,
+        widen( link, "C:\\work\\link" ),
+        widen( relative, "D:\\other\\main.c" )
+    );
+    check( equals( joined, "D:\\other\\main.c" ) );
+
+    result = symlink_join(
+        joined,
+        PATH_SIZE,
+        widen( link, "C:\\work\\link" ),
+        widen( relative, "\\\\server\\share\\main.c" )
+    );
+    check( equals( joined, "\\\\server\\share\\main.c" ) );
+
+    //joined paths that do not fit
+    result = symlink_join(
+        joined,
+        8,
+        widen( link, "C:\\work\\link" ),
+        widen( relative, "main.c" )
+    );
+    check( result == ERROR_OUTPUT_SIZE );
+
+    //report the results
+    printf( "test_symlink: %d failed check(s)\n", test_failures );
+    return test_failures;
+}
+
+
+/*=========================================================================*/
+static int equals(                  //compares UTF-16 to an ASCII string
+    const symlink_char_t*
+                        units,      //UTF-16 string
+    const char*         text        //ASCII string
+) {                                 //non-zero if the strings are equal
+
+    //compare each character, including the terminator
+    for( ; *text != 0; ++text, ++units ) {
+        if( *units != ( symlink_char_t ) *text ) {
+            return 0;
+        }
+    }
+    return *units == 0;
+}
+
+
+/*=========================================================================*/
+static const symlink_char_t* widen( //converts an ASCII string to UTF-16
+    symlink_char_t*     units,      //UTF-16 output (PATH_SIZE)
+    const char*         text        //ASCII string
+) {                                 //the UTF-16 output
+
+    //local variables
+    size_t              index;      //index into the strings
+
+    //copy each character, including the terminator
+    for(
+        index = 0;
+        ( ( index + 1 ) < PATH_SIZE ) && ( text[ index ] != 0 );
+        ++index
+    ) {
+        units[ index ] = ( symlink_char_t ) text[ index ];
+    }
+    units[ index ] = 0;
+    return units;
+}